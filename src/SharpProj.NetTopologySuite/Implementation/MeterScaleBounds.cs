@@ -0,0 +1,137 @@
+﻿using System;
+using NetTopologySuite.Geometries;
+using SharpProj.Proj;
+
+namespace SharpProj.Implementation
+{
+    /// <summary>
+    /// Bounds of the projection scale factor over the usage area of a projected <see cref="CoordinateReferenceSystem"/>. Allows
+    /// deciding meter distance questions from planar distances, without geodesic calculations
+    /// </summary>
+    /// <remarks>The factors are sampled on a (<see cref="Steps"/> + 1)² grid. The extremes found are widened by the largest difference
+    /// between neighbouring samples, and then by a further <see cref="SafetyMargin"/>, so an extreme between the samples would have to
+    /// exceed the sampled variation by that much to be missed</remarks>
+    internal sealed class MeterScaleBounds
+    {
+        const int Steps = 16;
+
+        /// <summary>Relative widening of the sampled bounds</summary>
+        const double SafetyMargin = 0.01;
+
+        MeterScaleBounds(Envelope area, double minScale, double maxScale)
+        {
+            Area = area;
+            MinScale = minScale;
+            MaxScale = maxScale;
+        }
+
+        /// <summary>
+        /// The area (in CRS coordinates) for which the bounds are valid
+        /// </summary>
+        public Envelope Area { get; }
+
+        /// <summary>
+        /// Lower bound of CRS units per meter on the ellipsoid
+        /// </summary>
+        public double MinScale { get; }
+
+        /// <summary>
+        /// Upper bound of CRS units per meter on the ellipsoid
+        /// </summary>
+        public double MaxScale { get; }
+
+        public bool Covers(Envelope envelope)
+        {
+            return Area.Covers(envelope);
+        }
+
+        /// <summary>
+        /// Lower bound in meters of a planar distance within <see cref="Area"/>
+        /// </summary>
+        public double MinMeters(double planarDistance)
+        {
+            return planarDistance / MaxScale;
+        }
+
+        /// <summary>
+        /// Upper bound in meters of a planar distance within <see cref="Area"/>
+        /// </summary>
+        public double MaxMeters(double planarDistance)
+        {
+            return planarDistance / MinScale;
+        }
+
+        /// <summary>
+        /// Samples the projection factors over the usage area of <paramref name="crs"/>
+        /// </summary>
+        /// <param name="crs"></param>
+        /// <returns>The bounds, or null if no bounds can be established</returns>
+        public static MeterScaleBounds Create(CoordinateReferenceSystem crs)
+        {
+            try
+            {
+                if (crs.Type != ProjType.ProjectedCrs)
+                    return null;
+
+                UsageArea ua = crs.UsageArea;
+                var axis = crs.Axis;
+
+                if (ua == null || axis == null || axis.Count < 2)
+                    return null;
+
+                double unit = axis[0].UnitConversionFactor;
+                double minX = ua.MinX, maxX = ua.MaxX;
+                double minY = ua.MinY, maxY = ua.MaxY;
+
+                if (!(unit > 0) || !(maxX > minX) || !(maxY > minY) || double.IsInfinity(maxX - minX) || double.IsInfinity(maxY - minY))
+                    return null;
+
+                double[,] kMin = new double[Steps + 1, Steps + 1];
+                double[,] kMax = new double[Steps + 1, Steps + 1];
+
+                using (CoordinateTransform dt = crs.DistanceTransform.Clone())
+                {
+                    for (int i = 0; i <= Steps; i++)
+                        for (int j = 0; j <= Steps; j++)
+                        {
+                            var f = dt.GeoFactors(new PPoint(minX + (maxX - minX) * i / Steps, minY + (maxY - minY) * j / Steps));
+
+                            if (f == null)
+                                return null;
+
+                            kMin[i, j] = f.TissotSemiminor;
+                            kMax[i, j] = f.TissotSemimajor;
+                        }
+                }
+
+                // The extremes may lie between the samples; widen by the largest change between neighbouring samples
+                double lo = double.MaxValue, hi = 0, step = 0;
+
+                for (int i = 0; i <= Steps; i++)
+                    for (int j = 0; j <= Steps; j++)
+                    {
+                        lo = Math.Min(lo, kMin[i, j]);
+                        hi = Math.Max(hi, kMax[i, j]);
+
+                        if (i > 0)
+                            step = Math.Max(step, Math.Max(Math.Abs(kMin[i, j] - kMin[i - 1, j]), Math.Abs(kMax[i, j] - kMax[i - 1, j])));
+                        if (j > 0)
+                            step = Math.Max(step, Math.Max(Math.Abs(kMin[i, j] - kMin[i, j - 1]), Math.Abs(kMax[i, j] - kMax[i, j - 1])));
+                    }
+
+                lo = (lo - step) * (1 - SafetyMargin);
+                hi = (hi + step) * (1 + SafetyMargin);
+
+                if (!(lo > 0) || double.IsInfinity(hi))
+                    return null;
+
+                // Factors are in projected meters per ellipsoid meter. Convert to CRS units
+                return new MeterScaleBounds(new Envelope(minX, maxX, minY, maxY), lo / unit, hi / unit);
+            }
+            catch (ProjException)
+            {
+                return null;
+            }
+        }
+    }
+}
@@ -0,0 +1,55 @@
+﻿using System;
+using System.Collections.Generic;
+using NetTopologySuite.Geometries;
+using SharpProj.NTS;
+
+namespace SharpProj.Implementation
+{
+    /// <summary>
+    /// Reprojects geometries to a single target on one thread, keeping the transforms it rented from the
+    /// <see cref="TransformPool"/>s until it is disposed
+    /// </summary>
+    internal sealed class ReprojectWorker : IDisposable
+    {
+        readonly SridItem _toSrid;
+        readonly Dictionary<int, KeyValuePair<TransformPool, CoordinateTransform>> _transforms = new Dictionary<int, KeyValuePair<TransformPool, CoordinateTransform>>();
+
+        public ReprojectWorker(SridItem toSrid)
+        {
+            _toSrid = toSrid;
+        }
+
+        /// <summary>
+        /// Reprojects <paramref name="geometry"/> from <paramref name="srcSRID"/>, or when that is 0 from the SRID of the geometry
+        /// (Parts of a collection use the SRID of the collection)
+        /// </summary>
+        public TGeometry Reproject<TGeometry>(TGeometry geometry, int srcSRID = 0)
+            where TGeometry : Geometry
+        {
+            if (geometry == null)
+                return null;
+
+            int srid = (srcSRID != 0) ? srcSRID : geometry.SRID;
+
+            if (!_transforms.TryGetValue(srid, out var t))
+            {
+                if (srid == 0)
+                    throw new ArgumentOutOfRangeException(nameof(geometry), "Geometry doesn't have valid srid");
+
+                TransformPool pool = SridRegister.GetByValue(srid).GetTransformPool(_toSrid);
+
+                _transforms[srid] = t = new KeyValuePair<TransformPool, CoordinateTransform>(pool, pool.Rent());
+            }
+
+            return geometry.Reproject(t.Value, _toSrid.Factory);
+        }
+
+        public void Dispose()
+        {
+            foreach (var t in _transforms.Values)
+                t.Key.Return(t.Value);
+
+            _transforms.Clear();
+        }
+    }
+}
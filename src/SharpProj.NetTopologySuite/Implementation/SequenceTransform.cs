@@ -0,0 +1,139 @@
+﻿using System;
+using System.Buffers;
+using NetTopologySuite.Geometries;
+using NetTopologySuite.Geometries.Implementation;
+
+namespace SharpProj.Implementation
+{
+    /// <summary>
+    /// Transforms whole <see cref="CoordinateSequence"/>s via <see cref="CoordinateTransform.ApplyGeneric"/>, reading the ordinates
+    /// directly from packed and per-axis sequences, without creating per vertex objects
+    /// </summary>
+    internal static class SequenceTransform
+    {
+        public static CoordinateSequence Transform(CoordinateTransform operation, CoordinateSequence sequence, CoordinateSequenceFactory factory)
+        {
+            int count = sequence.Count;
+            int dimension = sequence.Dimension;
+            int measures = sequence.Measures;
+
+            if (count == 0)
+                return factory.Create(0, dimension, measures);
+
+            if (sequence is PackedDoubleCoordinateSequence packed && factory is PackedCoordinateSequenceFactory pf && pf.Type == PackedCoordinateSequenceFactory.PackedType.Double)
+            {
+                double[] ordinates = (double[])packed.GetRawCoordinates().Clone();
+
+                Apply(operation, ordinates, 0, dimension, ordinates, 1, dimension, sequence.HasZ ? ordinates : null, 2, dimension, count);
+
+                return new PackedDoubleCoordinateSequence(ordinates, dimension, measures);
+            }
+            else if (sequence is DotSpatialAffineCoordinateSequence ds && factory is DotSpatialAffineCoordinateSequenceFactory)
+            {
+                double[] xy = (double[])ds.XY.Clone();
+                double[] z = (double[])ds.Z?.Clone();
+
+                Apply(operation, xy, 0, 2, xy, 1, 2, z, 0, 1, count);
+
+                return new DotSpatialAffineCoordinateSequence(xy, z, (double[])ds.M?.Clone());
+            }
+
+            // Other sequences: transform via a pooled buffer, and write the result into a sequence from the factory
+            bool hasZ = sequence.HasZ;
+            int stride = hasZ ? 3 : 2;
+            double[] buffer = ArrayPool<double>.Shared.Rent(count * stride);
+            try
+            {
+                for (int i = 0; i < count; i++)
+                {
+                    buffer[i * stride] = sequence.GetX(i);
+                    buffer[i * stride + 1] = sequence.GetY(i);
+                    if (hasZ)
+                        buffer[i * stride + 2] = sequence.GetZ(i);
+                }
+
+                Apply(operation, buffer, 0, stride, buffer, 1, stride, hasZ ? buffer : null, 2, stride, count);
+
+                CoordinateSequence result = factory.Create(count, dimension, measures);
+                int mIndex = dimension - measures;
+
+                for (int i = 0; i < count; i++)
+                {
+                    result.SetOrdinate(i, 0, buffer[i * stride]);
+                    result.SetOrdinate(i, 1, buffer[i * stride + 1]);
+                    if (hasZ && result.HasZ)
+                        result.SetOrdinate(i, 2, buffer[i * stride + 2]);
+                    if (measures > 0 && result.HasM)
+                        result.SetOrdinate(i, mIndex, sequence.GetM(i));
+                }
+
+                return result;
+            }
+            finally
+            {
+                ArrayPool<double>.Shared.Return(buffer);
+            }
+        }
+
+        // Transforms the x, y (and z) ordinates in place. Missing Z values (NaN) are transformed as 0, and stay missing
+        static void Apply(CoordinateTransform operation, double[] x, int xOffset, int xStride, double[] y, int yOffset, int yStride, double[] z, int zOffset, int zStride, int count)
+        {
+            int missing = 0;
+
+            if (z != null)
+            {
+                for (int i = 0; i < count; i++)
+                {
+                    if (double.IsNaN(z[zOffset + i * zStride]))
+                        missing++;
+                }
+
+                if (missing == count)
+                    z = null; // Plain 2D data. Z stays NaN
+            }
+
+            if (missing == 0 || z == null)
+            {
+                operation.ApplyGeneric(x, xOffset, xStride, y, yOffset, yStride, z, zOffset, zStride, null, 0, 0, count);
+                EnsureTransformed(x, xOffset, xStride, count);
+                return;
+            }
+
+            int[] gaps = ArrayPool<int>.Shared.Rent(missing);
+            try
+            {
+                for (int i = 0, n = 0; i < count; i++)
+                {
+                    if (double.IsNaN(z[zOffset + i * zStride]))
+                    {
+                        gaps[n++] = i;
+                        z[zOffset + i * zStride] = 0;
+                    }
+                }
+
+                operation.ApplyGeneric(x, xOffset, xStride, y, yOffset, yStride, z, zOffset, zStride, null, 0, 0, count);
+
+                for (int n = 0; n < missing; n++)
+                    z[zOffset + gaps[n] * zStride] = double.NaN;
+            }
+            finally
+            {
+                ArrayPool<int>.Shared.Return(gaps);
+            }
+
+            EnsureTransformed(x, xOffset, xStride, count);
+        }
+
+        // Failed points are returned as infinity. Fail like the per point Apply() instead of creating invalid geometries
+        static void EnsureTransformed(double[] x, int xOffset, int xStride, int count)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                double v = x[xOffset + i * xStride];
+
+                if (double.IsInfinity(v) || double.IsNaN(v))
+                    throw new ProjException("No usable transform found");
+            }
+        }
+    }
+}
@@ -0,0 +1,111 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Threading;
+using SharpProj.NTS;
+
+namespace SharpProj.Implementation
+{
+    /// <summary>
+    /// Ready to use transforms between two <see cref="SridItem"/>s. The operation is resolved once, after which every user gets
+    /// its own clone (with its own context), as transforms are not thread safe
+    /// </summary>
+    internal sealed class TransformPool : IDisposable
+    {
+        readonly SridItem _from, _to;
+        readonly CoordinateTransform _prototype;
+        readonly ConcurrentBag<CoordinateTransform> _idle = new ConcurrentBag<CoordinateTransform>();
+        readonly int _maxIdle = Math.Max(2, 2 * Environment.ProcessorCount);
+        int _idleCount;
+        volatile bool _disposed;
+
+        public TransformPool(SridItem from, SridItem to)
+        {
+            _from = from;
+            _to = to;
+            _prototype = CreateTransform(from, to);
+        }
+
+        static CoordinateTransform CreateTransform(SridItem from, SridItem to)
+        {
+            ProjContext pc = to.CRS.Context.Clone(); // Use settings from crs
+            try
+            {
+                return CoordinateTransform.Create(from, to, pc);
+            }
+            catch
+            {
+                pc.Dispose();
+                throw;
+            }
+        }
+
+        /// <summary>
+        /// Gets a transform for use by the calling thread. Hand it back via <see cref="Return"/>
+        /// </summary>
+        /// <remarks>A pool disposed by <see cref="SridItem.ClearTransformCache"/> while it was obtained still works, by creating a
+        /// new transform (released again by <see cref="Return"/>)</remarks>
+        public CoordinateTransform Rent()
+        {
+            if (_idle.TryTake(out var t))
+            {
+                Interlocked.Decrement(ref _idleCount);
+                return t;
+            }
+
+            lock (_prototype)
+            {
+                if (!_disposed)
+                    return _prototype.Clone();
+            }
+
+            return CreateTransform(_from, _to);
+        }
+
+        public void Return(CoordinateTransform transform)
+        {
+            if (transform is null)
+                return;
+
+            if (!_disposed && Interlocked.Increment(ref _idleCount) <= _maxIdle)
+            {
+                _idle.Add(transform);
+
+                if (_disposed)
+                    DisposeIdle(); // Raced with Dispose()
+            }
+            else
+            {
+                if (!_disposed)
+                    Interlocked.Decrement(ref _idleCount);
+
+                Release(transform);
+            }
+        }
+
+        public void Dispose()
+        {
+            lock (_prototype)
+            {
+                if (_disposed)
+                    return;
+
+                _disposed = true;
+                DisposeIdle();
+                Release(_prototype);
+            }
+        }
+
+        void DisposeIdle()
+        {
+            while (_idle.TryTake(out var t))
+                Release(t);
+        }
+
+        static void Release(CoordinateTransform transform)
+        {
+            ProjContext ctx = transform.Context;
+            transform.Dispose();
+            ctx.Dispose();
+        }
+    }
+}
@@ -0,0 +1,51 @@
+﻿using System;
+using System.Diagnostics;
+
+namespace SharpProj.NTS
+{
+    /// <summary>
+    /// Area and perimeter of a (multi)polygon, calculated over the ellipsoid
+    /// </summary>
+    [DebuggerDisplay("Area={Area}, Length={Length}")]
+    public struct MeterMetrics : IEquatable<MeterMetrics>
+    {
+        /// <summary>
+        /// Creates a new <see cref="MeterMetrics"/> instance
+        /// </summary>
+        /// <param name="area"></param>
+        /// <param name="length"></param>
+        public MeterMetrics(double area, double length)
+        {
+            Area = area;
+            Length = length;
+        }
+
+        /// <summary>
+        /// The area in square meters
+        /// </summary>
+        public double Area { get; }
+
+        /// <summary>
+        /// The total length of all rings in meters
+        /// </summary>
+        public double Length { get; }
+
+        /// <inheritdoc />
+        public bool Equals(MeterMetrics other)
+        {
+            return Area == other.Area && Length == other.Length;
+        }
+
+        /// <inheritdoc />
+        public override bool Equals(object obj)
+        {
+            return obj is MeterMetrics other && Equals(other);
+        }
+
+        /// <inheritdoc />
+        public override int GetHashCode()
+        {
+            return Area.GetHashCode() ^ Length.GetHashCode();
+        }
+    }
+}
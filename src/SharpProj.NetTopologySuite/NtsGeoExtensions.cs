@@ -1,5 +1,8 @@
 ﻿using System;
+using System.Collections.Generic;
+using System.Threading.Tasks;
 using SharpProj;
+using SharpProj.Implementation;
 using SharpProj.NTS;
 
 using DistanceOp = NetTopologySuite.Operation.Distance.DistanceOp;
@@ -83,9 +86,6 @@ namespace NetTopologySuite.Geometries
             if (srid == 0 || g1.SRID != g0.SRID)
                 throw new ArgumentOutOfRangeException("SRID is 0 or doesn't match");
 
-            DistanceOp distanceOp = new DistanceOp(g0, g1);
-            Coordinate[] nearestPoints = distanceOp.NearestPoints();
-
             SridItem sridItem;
             try
             {
@@ -96,9 +96,34 @@ namespace NetTopologySuite.Geometries
                 throw new ArgumentOutOfRangeException("SRID not resolveable", sridExcepton);
             }
 
-            // TODO: There should be possible optimizations now, with knowledg of the CRS
-            //       Maybe we can assume that this is always false if the NTS cut-off thinks it's false
-            //       Not 100% sure and we want correctness
+            // The scale bounds give the (conservatively widened) range of meters a planar distance can represent. The result of the
+            // exact calculation below is within that range for the NTS distance, which itself is between the envelope distance and the
+            // distance between any two vertices. So when the range is completely on one side of the limit we are done.
+            MeterScaleBounds sb = sridItem.ScaleBounds;
+
+            if (sb != null && (g0.IsEmpty || g1.IsEmpty || !sb.Covers(g0.EnvelopeInternal) || !sb.Covers(g1.EnvelopeInternal)))
+                sb = null;
+
+            if (sb != null)
+            {
+                if (sb.MinMeters(g0.EnvelopeInternal.Distance(g1.EnvelopeInternal)) > distanceInMeter)
+                    return false;
+                else if (sb.MaxMeters(g0.Coordinate.Distance(g1.Coordinate)) <= distanceInMeter)
+                    return true;
+            }
+
+            DistanceOp distanceOp = new DistanceOp(g0, g1);
+            Coordinate[] nearestPoints = distanceOp.NearestPoints();
+
+            if (sb != null)
+            {
+                double planar = nearestPoints[0].Distance(nearestPoints[1]);
+
+                if (sb.MinMeters(planar) > distanceInMeter)
+                    return false;
+                else if (sb.MaxMeters(planar) <= distanceInMeter)
+                    return true;
+            }
 
             using (var dt = sridItem.CRS.DistanceTransform.Clone()) // Thread safe with clone
             {
@@ -288,7 +313,13 @@ namespace NetTopologySuite.Geometries
 
         private static double? SignedRingArea(LineString ring, CoordinateTransform dt)
         {
-            double d = dt.GeoArea(ring.CoordinateSequence.ToPPoints());
+            double factor = dt.EqualAreaFactor;
+            double d;
+
+            if (!double.IsNaN(factor))
+                d = NetTopologySuite.Algorithm.Area.OfRingSigned(ring.CoordinateSequence) * factor; // Equal area projection. No need to leave NTS
+            else
+                d = dt.GeoArea(ring.CoordinateSequence.ToPPoints());
 
             if (double.IsInfinity(d) || double.IsNaN(d))
                 return null;
@@ -296,6 +327,125 @@ namespace NetTopologySuite.Geometries
                 return d;
         }
 
+        /// <summary>
+        /// Gets the area (in square meters) and perimeter (in meters) of polygon <paramref name="p"/> in a single pass over the coordinates (via SharpProj)
+        /// </summary>
+        /// <param name="p"></param>
+        /// <returns>The metrics, or null if unable to calculate</returns>
+        public static MeterMetrics? GeoMetrics(this Polygon p)
+        {
+            if (p == null)
+                throw new ArgumentNullException(nameof(p));
+
+            return GeoMetrics(p, new[] { p });
+        }
+
+        /// <summary>
+        /// Gets the area (in square meters) and perimeter (in meters) of the polygons in <paramref name="mp"/> in a single pass over the coordinates (via SharpProj).
+        /// Large multipolygons are handled in parallel
+        /// </summary>
+        /// <param name="mp"></param>
+        /// <returns>The metrics, or null if unable to calculate</returns>
+        public static MeterMetrics? GeoMetrics(this MultiPolygon mp)
+        {
+            if (mp == null)
+                throw new ArgumentNullException(nameof(mp));
+
+            Polygon[] polygons = new Polygon[mp.NumGeometries];
+
+            for (int i = 0; i < polygons.Length; i++)
+                polygons[i] = (Polygon)mp.GetGeometryN(i);
+
+            return GeoMetrics(mp, polygons);
+        }
+
+        // Below this number of vertices the setup cost of the parallel calculation is higher than the gain
+        const int ParallelGeoMetricsThreshold = 8192;
+
+        private static MeterMetrics? GeoMetrics(Geometry g, Polygon[] polygons)
+        {
+            int srid = g.SRID;
+            if (srid == 0)
+                throw new ArgumentOutOfRangeException("SRID is 0 or doesn't match");
+
+            SridItem sridItem;
+            try
+            {
+                sridItem = SridRegister.GetByValue(srid);
+            }
+            catch (IndexOutOfRangeException sridExcepton)
+            {
+                throw new ArgumentOutOfRangeException("SRID not resolveable", sridExcepton);
+            }
+
+            List<LineString> rings = new List<LineString>();
+            int[] firstRing = new int[polygons.Length + 1];
+            int vertices = 0;
+
+            for (int i = 0; i < polygons.Length; i++)
+            {
+                firstRing[i] = rings.Count;
+
+                if (polygons[i].IsEmpty)
+                    continue;
+
+                rings.Add(polygons[i].ExteriorRing);
+                rings.AddRange(polygons[i].InteriorRings);
+                vertices += polygons[i].NumPoints;
+            }
+            firstRing[polygons.Length] = rings.Count;
+
+            double[] areas = new double[rings.Count];
+            double[] lengths = new double[rings.Count];
+
+            using (var dt = sridItem.CRS.DistanceTransform.Clone()) // Thread safe with clone
+            {
+                if (rings.Count > 1 && vertices >= ParallelGeoMetricsThreshold && Environment.ProcessorCount > 1)
+                {
+                    // Every worker gets its own transform, as transforms are not thread safe
+                    Parallel.For(0, rings.Count,
+                        () => { lock (dt) { return dt.Clone(); } },
+                        (i, state, t) =>
+                        {
+                            areas[i] = t.GeoArea(rings[i].CoordinateSequence.ToPPoints(), out lengths[i]);
+                            return t;
+                        },
+                        t =>
+                        {
+                            ProjContext ctx = t.Context;
+                            t.Dispose();
+                            ctx.Dispose();
+                        });
+                }
+                else
+                {
+                    for (int i = 0; i < rings.Count; i++)
+                        areas[i] = dt.GeoArea(rings[i].CoordinateSequence.ToPPoints(), out lengths[i]);
+                }
+            }
+
+            double area = 0, length = 0;
+
+            for (int i = 0; i < polygons.Length; i++)
+            {
+                // Holes have the opposite sign of the shell. The orientation of the shell doesn't matter
+                double signedArea = 0;
+
+                for (int r = firstRing[i]; r < firstRing[i + 1]; r++)
+                {
+                    if (double.IsInfinity(areas[r]) || double.IsNaN(areas[r]) || double.IsInfinity(lengths[r]) || double.IsNaN(lengths[r]))
+                        return null;
+
+                    signedArea += areas[r];
+                    length += lengths[r];
+                }
+
+                area += Math.Abs(signedArea);
+            }
+
+            return new MeterMetrics(area, length);
+        }
+
         /// <summary>
         /// Gets the meterlengths of the <see cref="Polygon"/>, <see cref="LineString"/> and <see cref="GeometryCollection"/> instances in <paramref name="gc"/> in meters
         /// </summary>
@@ -1,7 +1,9 @@
 ﻿using System;
 using System.Collections.Generic;
 using System.Linq;
+using System.Threading.Tasks;
 using NetTopologySuite.Geometries;
+using SharpProj.Implementation;
 using SharpProj.NTS;
 
 namespace SharpProj
@@ -112,13 +114,119 @@ namespace SharpProj
             if (srcSRID == 0)
                 throw new ArgumentOutOfRangeException(nameof(geometry), "Geometry doesn't have valid srid");
 
-            SridItem srcItem = SridRegister.GetByValue(srcSRID);
+            if (geometry is GeometryCollection gc && gc.NumGeometries > 1 && Environment.ProcessorCount > 1
+                && IsPlainCollection(gc) && gc.NumPoints >= ParallelReprojectThreshold)
+            {
+                return (TGeometry)ReprojectCollectionParallel(gc, srcSRID, toSrid);
+            }
 
-            using (ProjContext pc = toSrid.CRS.Context.Clone()) // Make thread-safe. Use settings from crs
-            using (CoordinateTransform ct = CoordinateTransform.Create(srcItem, toSrid, pc))
+            SridItem srcItem = SridRegister.GetByValue(srcSRID);
+            var pool = srcItem.GetTransformPool(toSrid); // Resolves the operation once per pair
+            CoordinateTransform ct = pool.Rent();
+            try
             {
                 return Reproject(geometry, ct, toSrid.Factory);
             }
+            finally
+            {
+                pool.Return(ct);
+            }
+        }
+
+        // Below this number of vertices the setup cost of the parallel reprojection is higher than the gain
+        const int ParallelReprojectThreshold = 16384;
+
+        /// <summary>
+        /// Reprojects all <paramref name="geometries"/> to <paramref name="toSrid"/>, spreading the work over all cores when there
+        /// are enough vertices to make that worthwhile. The result has the same order as the input. Null items stay null
+        /// </summary>
+        /// <typeparam name="TGeometry"></typeparam>
+        /// <param name="geometries"></param>
+        /// <param name="toSrid"></param>
+        /// <returns></returns>
+        public static TGeometry[] ReprojectParallel<TGeometry>(this IReadOnlyList<TGeometry> geometries, SridItem toSrid)
+            where TGeometry : Geometry
+        {
+            if (geometries == null)
+                throw new ArgumentNullException(nameof(geometries));
+            else if (toSrid == null)
+                throw new ArgumentNullException(nameof(toSrid));
+
+            return ReprojectAll(geometries, 0, toSrid);
+        }
+
+        // Reprojects from srcSRID, or when that is 0 from the SRID of every geometry
+        static TGeometry[] ReprojectAll<TGeometry>(IReadOnlyList<TGeometry> geometries, int srcSRID, SridItem toSrid)
+            where TGeometry : Geometry
+        {
+            TGeometry[] result = new TGeometry[geometries.Count];
+            bool parallel = false;
+
+            if (geometries.Count > 1 && Environment.ProcessorCount > 1)
+            {
+                long vertices = 0;
+
+                for (int i = 0; i < geometries.Count && !parallel; i++)
+                {
+                    vertices += geometries[i]?.NumPoints ?? 0;
+                    parallel = (vertices >= ParallelReprojectThreshold);
+                }
+            }
+
+            if (parallel)
+            {
+                // Every worker gets its own transforms, as transforms are not thread safe
+                Parallel.For(0, geometries.Count,
+                    () => new ReprojectWorker(toSrid),
+                    (i, state, w) =>
+                    {
+                        result[i] = w.Reproject(geometries[i], srcSRID);
+                        return w;
+                    },
+                    w => w.Dispose());
+            }
+            else
+            {
+                using (var w = new ReprojectWorker(toSrid))
+                {
+                    for (int i = 0; i < geometries.Count; i++)
+                        result[i] = w.Reproject(geometries[i], srcSRID);
+                }
+            }
+
+            return result;
+        }
+
+        // Collections that can be rebuilt from their parts without losing information
+        static bool IsPlainCollection(GeometryCollection gc)
+        {
+            Type t = gc.GetType();
+
+            return t == typeof(GeometryCollection) || t == typeof(MultiPolygon) || t == typeof(MultiLineString) || t == typeof(MultiPoint);
+        }
+
+        // The parts are reprojected from the SRID of the collection, like the serial path does, whatever the SRID of the parts
+        static Geometry ReprojectCollectionParallel(GeometryCollection gc, int srcSRID, SridItem toSrid)
+        {
+            Geometry[] parts = new Geometry[gc.NumGeometries];
+
+            for (int i = 0; i < parts.Length; i++)
+                parts[i] = gc.GetGeometryN(i);
+
+            parts = ReprojectAll(parts, srcSRID, toSrid);
+            GeometryFactory f = toSrid.Factory;
+
+            switch (gc)
+            {
+                case MultiPolygon _:
+                    return f.CreateMultiPolygon(Array.ConvertAll(parts, p => (Polygon)p));
+                case MultiLineString _:
+                    return f.CreateMultiLineString(Array.ConvertAll(parts, p => (LineString)p));
+                case MultiPoint _:
+                    return f.CreateMultiPoint(Array.ConvertAll(parts, p => (Point)p));
+                default:
+                    return f.CreateGeometryCollection(parts);
+            }
         }
 
         /// <summary>
@@ -158,7 +266,27 @@ namespace SharpProj
                 throw new ArgumentNullException(nameof(factory));
 
             return SridRegister.ReProject(geometry, factory,
-                sq => factory.CoordinateSequenceFactory.Create(sq.ToPPoints().Select(x => operation.Apply(x)).ToCoordinates().ToArray()));
+                sq => SequenceTransform.Transform(operation, sq, factory.CoordinateSequenceFactory));
+        }
+
+        /// <summary>
+        /// Transforms all coordinates of <paramref name="sequence"/> in one batch, into a new sequence created by <paramref name="factory"/>.
+        /// Packed and DotSpatial sequences are transformed directly from their ordinate buffers
+        /// </summary>
+        /// <param name="op"></param>
+        /// <param name="sequence"></param>
+        /// <param name="factory"></param>
+        /// <returns></returns>
+        public static CoordinateSequence Apply(this CoordinateTransform op, CoordinateSequence sequence, CoordinateSequenceFactory factory)
+        {
+            if (op is null)
+                throw new ArgumentNullException(nameof(op));
+            else if (sequence is null)
+                throw new ArgumentNullException(nameof(sequence));
+            else if (factory is null)
+                throw new ArgumentNullException(nameof(factory));
+
+            return SequenceTransform.Transform(op, sequence, factory);
         }
 
         /// <summary>
@@ -239,6 +367,67 @@ namespace SharpProj
         {
             return operation.GeoArea(coordinates.Select(x => x.ToPPoint()));
         }
+
+        /// <summary>
+        /// Creates a <see cref="GeoIndex"/> for meter based nearest neighbour and radius queries over <paramref name="coordinates"/>,
+        /// which are in the coordinate system of <paramref name="sridItem"/>
+        /// </summary>
+        /// <param name="sridItem"></param>
+        /// <param name="coordinates"></param>
+        /// <returns></returns>
+        public static GeoIndex CreateGeoIndex(this SridItem sridItem, IEnumerable<Coordinate> coordinates)
+        {
+            if (sridItem == null)
+                throw new ArgumentNullException(nameof(sridItem));
+            else if (coordinates == null)
+                throw new ArgumentNullException(nameof(coordinates));
+
+            return new GeoIndex(sridItem.CRS, coordinates.ToPPoints());
+        }
+
+        /// <summary>
+        /// Creates a <see cref="GeoIndex"/> for meter based nearest neighbour and radius queries over <paramref name="coordinates"/>,
+        /// which are in the coordinate system of <paramref name="sridItem"/>
+        /// </summary>
+        /// <param name="sridItem"></param>
+        /// <param name="coordinates"></param>
+        /// <returns></returns>
+        public static GeoIndex CreateGeoIndex(this SridItem sridItem, ReadOnlySpan<Coordinate> coordinates)
+        {
+            if (sridItem == null)
+                throw new ArgumentNullException(nameof(sridItem));
+
+            PPoint[] points = new PPoint[coordinates.Length];
+
+            for (int i = 0; i < coordinates.Length; i++)
+                points[i] = coordinates[i].ToPPoint();
+
+            return new GeoIndex(sridItem.CRS, points);
+        }
+
+        /// <summary>
+        /// Wraps <see cref="GeoIndex.Nearest(PPoint, int)"/> for NTS
+        /// </summary>
+        /// <param name="index"></param>
+        /// <param name="c"></param>
+        /// <param name="count"></param>
+        /// <returns></returns>
+        public static GeoIndexMatch[] Nearest(this GeoIndex index, Coordinate c, int count)
+        {
+            return index.Nearest(c.ToPPoint(), count);
+        }
+
+        /// <summary>
+        /// Wraps <see cref="GeoIndex.WithinDistance(PPoint, double)"/> for NTS
+        /// </summary>
+        /// <param name="index"></param>
+        /// <param name="c"></param>
+        /// <param name="distanceInMeter"></param>
+        /// <returns></returns>
+        public static GeoIndexMatch[] WithinDistance(this GeoIndex index, Coordinate c, double distanceInMeter)
+        {
+            return index.WithinDistance(c.ToPPoint(), distanceInMeter);
+        }
     }
 
 }
@@ -1,8 +1,10 @@
 ﻿using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Diagnostics;
 using NetTopologySuite;
 using NetTopologySuite.Geometries;
+using SharpProj.Implementation;
 
 namespace SharpProj.NTS
 {
@@ -13,6 +15,8 @@ namespace SharpProj.NTS
     public sealed class SridItem
     {
         readonly Lazy<GeometryFactory> _factory;
+        readonly Lazy<MeterScaleBounds> _scaleBounds;
+        readonly ConcurrentDictionary<SridItem, Lazy<TransformPool>> _transforms = new ConcurrentDictionary<SridItem, Lazy<TransformPool>>();
 
         /// <summary>
         /// The unique SRID value used in NetTopologySuite
@@ -81,6 +85,7 @@ namespace SharpProj.NTS
             CRS = crs;
 
             _factory = new Lazy<GeometryFactory>(() => NtsGeometryServices.Instance.CreateGeometryFactory(srid));
+            _scaleBounds = new Lazy<MeterScaleBounds>(() => MeterScaleBounds.Create(crs));
         }
 
         /// <summary>
@@ -134,5 +139,37 @@ namespace SharpProj.NTS
         /// The factory used to construct new geometries for this <see cref="SridItem"/>
         /// </summary>
         public GeometryFactory Factory => _factory.Value;
+
+        // Null when the CRS is not projected, or the bounds can't be calculated
+        internal MeterScaleBounds ScaleBounds => _scaleBounds.Value;
+
+        // The transforms from this item to toSrid, created on first use
+        internal TransformPool GetTransformPool(SridItem toSrid)
+        {
+            var pool = _transforms.GetOrAdd(toSrid, to => new Lazy<TransformPool>(() => new TransformPool(this, to)));
+
+            try
+            {
+                return pool.Value;
+            }
+            catch
+            {
+                ((ICollection<KeyValuePair<SridItem, Lazy<TransformPool>>>)_transforms).Remove(new KeyValuePair<SridItem, Lazy<TransformPool>>(toSrid, pool)); // Retry next time
+                throw;
+            }
+        }
+
+        /// <summary>
+        /// Releases the transforms from this item to other items that <see cref="NtsExtensions.Reproject{TGeometry}(TGeometry, SridItem)"/>
+        /// keeps for reuse. Call this after changing context settings (e.g. network access) that affect the chosen operations
+        /// </summary>
+        public void ClearTransformCache()
+        {
+            foreach (var key in _transforms.Keys)
+            {
+                if (_transforms.TryRemove(key, out var pool) && pool.IsValueCreated)
+                    pool.Value.Dispose();
+            }
+        }
     }
 }
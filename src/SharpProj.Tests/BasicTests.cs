@@ -147,6 +147,331 @@ namespace SharpProj.Tests
 
 
                 }
+
+                // Repeated lookups must not grow the strings retained by the context
+                long retained = pc.RetainedStringBytes;
+                for (int i = 0; i < 10; i++)
+                {
+                    using (var crs = CoordinateReferenceSystem.Create("EPSG:25832", pc))
+                    {
+                        Assert.AreEqual("ETRS89 / UTM zone 32N", crs.Name);
+                    }
+                }
+                Assert.AreEqual(retained, pc.RetainedStringBytes);
+
+                // Metadata strings are shared between instances
+                using (var crs1 = CoordinateReferenceSystem.Create("EPSG:25832", pc))
+                using (var crs2 = CoordinateReferenceSystem.Create("EPSG:25832", pc))
+                {
+                    Assert.AreSame(crs1.Name, crs2.Name);
+                    Assert.AreSame(crs1.Axis[0].Name, crs2.Axis[0].Name);
+                }
+            }
+        }
+
+        [TestMethod]
+        public void ContextPool()
+        {
+            using (var pc = new ProjContext())
+            {
+                pc.LogLevel = ProjLogLevel.Debug;
+
+                using (var pool = new ProjContextPool(pc, 4))
+                {
+                    Assert.AreEqual(4, pool.Size);
+                    Assert.AreEqual(4, pool.Available);
+
+                    Parallel.For(0, 64, i =>
+                    {
+                        ProjContext ctx = pool.Lease();
+                        try
+                        {
+                            Assert.AreEqual(ProjLogLevel.Debug, ctx.LogLevel);
+                            ctx.LogLevel = ProjLogLevel.Trace;
+
+                            using (var crs = CoordinateReferenceSystem.Create("EPSG:25832", ctx))
+                            {
+                                Assert.AreEqual("ETRS89 / UTM zone 32N", crs.Name);
+                            }
+                        }
+                        finally
+                        {
+                            pool.Return(ctx);
+                        }
+                    });
+
+                    Assert.AreEqual(4, pool.Available);
+
+                    ProjContext[] all = Enumerable.Range(0, 4).Select(_ => pool.Lease()).ToArray();
+                    Assert.IsFalse(pool.TryLease(TimeSpan.FromMilliseconds(10), out var none));
+                    Assert.IsNull(none);
+
+                    foreach (var c in all)
+                        pool.Return(c);
+                }
+            }
+        }
+
+        [TestMethod]
+        public void SharedDatabase()
+        {
+            bool old = ProjContext.EnableSharedDatabaseOnNewContexts;
+            ProjContext.EnableSharedDatabaseOnNewContexts = true;
+            try
+            {
+                long fetches = ProjNetwork.GetStatistics().DatabasePageFetches;
+
+                using (var pc = new ProjContext())
+                using (var pc2 = pc.Clone())
+                {
+                    Parallel.ForEach(new[] { pc, pc2 }, ctx =>
+                    {
+                        using (var crs = CoordinateReferenceSystem.Create("EPSG:25832", ctx))
+                        {
+                            Assert.AreEqual("ETRS89 / UTM zone 32N", crs.Name);
+                        }
+                    });
+
+                    Assert.AreEqual(pc.EpsgVersion, pc2.EpsgVersion);
+                }
+
+                Assert.IsTrue(ProjNetwork.GetStatistics().DatabasePageFetches > fetches, "Pages used from the mapping");
+            }
+            finally
+            {
+                ProjContext.EnableSharedDatabaseOnNewContexts = old;
+            }
+        }
+
+        [TestMethod]
+        public void InMemoryDatabase()
+        {
+            string dbFile = Path.Combine(AppDomain.CurrentDomain.BaseDirectory, "proj.db");
+
+            if (!File.Exists(dbFile))
+                Assert.Inconclusive("proj.db not found");
+
+            using (var fs = File.OpenRead(dbFile))
+                ProjContext.UseInMemoryDatabase(fs);
+            try
+            {
+                using (var pc = new ProjContext())
+                using (var crs = CoordinateReferenceSystem.Create("EPSG:25832", pc))
+                {
+                    Assert.AreEqual("ETRS89 / UTM zone 32N", crs.Name);
+                    Assert.IsNotNull(pc.EpsgVersion);
+                }
+            }
+            finally
+            {
+                ProjContext.DisableInMemoryDatabase();
+            }
+        }
+
+        // Whether a transform using the (vertical) grid name can be created and applied via pc
+        static bool GridFound(ProjContext pc, string name)
+        {
+            try
+            {
+                using (var t = TestGrid.CreateVerticalTransform(pc, name))
+                {
+                    return !double.IsInfinity(t.Apply(TestGrid.GtxLon + 0.05, TestGrid.GtxLat + 0.05, 0)[2]);
+                }
+            }
+            catch (ProjException)
+            {
+                return false;
+            }
+        }
+
+        [TestMethod]
+        public void FileResolutionCache()
+        {
+            TimeSpan old = ProjContext.FileNotFoundCacheTime;
+            byte[] grid = TestGrid.CreateGtx(10, 10);
+
+            using (var dir = TestGrid.CreateTempDirectory())
+            using (var dir2 = TestGrid.CreateTempDirectory())
+            using (var pc = new ProjContext())
+            {
+                pc.AllowNetworkConnections = false;
+                try
+                {
+                    using (new EnvironmentScope("PROJ_LIB", dir.Path))
+                    {
+                        // Not found is remembered until ClearFileCache
+                        string name = "sharpproj-" + Guid.NewGuid().ToString("N") + ".gtx";
+                        ProjContext.FileNotFoundCacheTime = TimeSpan.FromHours(1);
+                        Assert.IsFalse(GridFound(pc, name));
+                        File.WriteAllBytes(Path.Combine(dir.Path, name), grid);
+                        Assert.IsFalse(GridFound(pc, name), "Cached as not found");
+                        ProjContext.ClearFileCache();
+                        Assert.IsTrue(GridFound(pc, name));
+
+                        // A removed file is no longer served from the cache
+                        File.Delete(Path.Combine(dir.Path, name));
+                        Assert.IsFalse(GridFound(pc, name));
+
+                        // ... or until FileNotFoundCacheTime passed
+                        name = "sharpproj-" + Guid.NewGuid().ToString("N") + ".gtx";
+                        ProjContext.FileNotFoundCacheTime = TimeSpan.FromMilliseconds(200);
+                        Assert.IsFalse(GridFound(pc, name));
+                        File.WriteAllBytes(Path.Combine(dir.Path, name), grid);
+                        System.Threading.Thread.Sleep(400);
+                        Assert.IsTrue(GridFound(pc, name), "Expired");
+
+                        // The key includes PROJ_LIB, so changing it doesn't reuse the result
+                        name = "sharpproj-" + Guid.NewGuid().ToString("N") + ".gtx";
+                        ProjContext.FileNotFoundCacheTime = TimeSpan.FromHours(1);
+                        File.WriteAllBytes(Path.Combine(dir2.Path, name), grid);
+                        Assert.IsFalse(GridFound(pc, name));
+
+                        using (new EnvironmentScope("PROJ_LIB", dir2.Path))
+                        {
+                            Assert.IsTrue(GridFound(pc, name));
+                        }
+                        Assert.IsFalse(GridFound(pc, name));
+                    }
+                }
+                finally
+                {
+                    ProjContext.FileNotFoundCacheTime = old;
+                    ProjContext.ClearFileCache();
+                }
+            }
+        }
+
+        [TestMethod]
+        public void RegisteredGrids()
+        {
+            byte[] grid = TestGrid.CreateGtx(10, 10);
+            string fromArray = "sharpproj-" + Guid.NewGuid().ToString("N") + ".gtx";
+            string fromStream = "sharpproj-" + Guid.NewGuid().ToString("N") + ".gtx";
+
+            ProjContext.RegisterGrid(fromArray, grid);
+            try
+            {
+                using (var ms = new MemoryStream())
+                {
+                    // Registered from the current position
+                    ms.Write(new byte[] { 1, 2, 3 }, 0, 3);
+                    ms.Write(grid, 0, grid.Length);
+                    ms.Position = 3;
+                    ProjContext.RegisterGrid(fromStream, ms);
+                }
+
+                using (var pc = new ProjContext())
+                {
+                    pc.AllowNetworkConnections = false;
+
+                    // Neither exists on disk
+                    Assert.IsTrue(GridFound(pc, fromArray));
+                    Assert.IsTrue(GridFound(pc, fromStream));
+
+                    Assert.IsTrue(ProjContext.UnregisterGrid(fromArray));
+                    Assert.IsFalse(ProjContext.UnregisterGrid(fromArray));
+                    Assert.IsFalse(GridFound(pc, fromArray));
+                    Assert.IsTrue(GridFound(pc, fromStream));
+                }
+            }
+            finally
+            {
+                ProjContext.UnregisterGrid(fromArray);
+                ProjContext.UnregisterGrid(fromStream);
+            }
+        }
+
+        [TestMethod]
+        public void SharedGridFiles()
+        {
+            string name = "sharpproj-shared-" + Guid.NewGuid().ToString("N") + ".tif";
+            bool old = ProjContext.EnableSharedGridFilesOnNewContexts;
+
+            using (var dir = TestGrid.CreateTempDirectory())
+            {
+                File.Copy(TestGrid.GetPath(), Path.Combine(dir.Path, name));
+
+                using (new EnvironmentScope("PROJ_LIB", dir.Path))
+                {
+                    ProjContext.EnableSharedGridFilesOnNewContexts = true;
+                    try
+                    {
+                        long before = ProjNetwork.GetStatistics().FileMappings;
+
+                        using (var pc1 = new ProjContext())
+                        using (var t1 = TestGrid.CreateTransform(pc1, name))
+                        {
+                            var r1 = t1.Apply(new PPoint(4, 51));
+                            long mapped = ProjNetwork.GetStatistics().FileMappings;
+                            Assert.IsTrue(mapped > before, "Grid mapped");
+
+                            // The first context keeps the grid open, so the second one must use the same mapping
+                            using (var pc2 = new ProjContext())
+                            using (var t2 = TestGrid.CreateTransform(pc2, name))
+                            {
+                                var r2 = t2.Apply(new PPoint(4, 51));
+
+                                Assert.AreEqual(mapped, ProjNetwork.GetStatistics().FileMappings, "Mapping shared by second context");
+                                Assert.AreEqual(new PPoint(4.0, 50.999), r1.RoundXY(3));
+                                Assert.AreEqual(r1, r2);
+                            }
+                        }
+                    }
+                    finally
+                    {
+                        ProjContext.EnableSharedGridFilesOnNewContexts = old;
+                    }
+                }
+            }
+        }
+
+        [TestMethod]
+        public void SharedGridFilesReplacedAndCloned()
+        {
+            string name = "sharpproj-shared-" + Guid.NewGuid().ToString("N") + ".gtx";
+            bool old = ProjContext.EnableSharedGridFilesOnNewContexts;
+
+            using (var dir = TestGrid.CreateTempDirectory())
+            using (new EnvironmentScope("PROJ_LIB", dir.Path))
+            {
+                string file = Path.Combine(dir.Path, name);
+                File.WriteAllBytes(file, TestGrid.CreateGtx(10, 10));
+
+                ProjContext.EnableSharedGridFilesOnNewContexts = true;
+                try
+                {
+                    using (var pc1 = new ProjContext())
+                    {
+                        ProjContext.EnableSharedGridFilesOnNewContexts = false;
+                        long before = ProjNetwork.GetStatistics().FileMappings;
+
+                        using (var t1 = TestGrid.CreateVerticalTransform(pc1, name))
+                        {
+                            Assert.AreEqual(5, t1.Apply(TestGrid.GtxLon, TestGrid.GtxLat + 0.05, 0)[2], 0.0001);
+                            long mapped = ProjNetwork.GetStatistics().FileMappings;
+                            Assert.AreEqual(before + 1, mapped, "Grid mapped");
+
+                            // Replace the file while it is mapped
+                            File.Move(file, file + ".old");
+                            File.WriteAllBytes(file, TestGrid.CreateGtx(20, 20));
+
+                            // The clone maps files like its original, and gets the new version
+                            using (var pc2 = pc1.Clone())
+                            using (var t2 = TestGrid.CreateVerticalTransform(pc2, name))
+                            {
+                                Assert.AreEqual(15, t2.Apply(TestGrid.GtxLon, TestGrid.GtxLat + 0.15, 0)[2], 0.0001);
+                                Assert.AreEqual(mapped + 1, ProjNetwork.GetStatistics().FileMappings, "New version mapped");
+                            }
+
+                            // The old version stays available to the first context
+                            Assert.AreEqual(5, t1.Apply(TestGrid.GtxLon, TestGrid.GtxLat + 0.05, 0)[2], 0.0001);
+                        }
+                    }
+                }
+                finally
+                {
+                    ProjContext.EnableSharedGridFilesOnNewContexts = old;
+                }
             }
         }
 
@@ -481,6 +806,9 @@ namespace SharpProj.Tests
 
                         Assert.IsTrue(cl[0].GridUsageCount > 0);
                         Assert.IsTrue(cl[1].GridUsageCount == 0);
+                        Assert.AreEqual(cl[0].GridUsageCount, cl[0].Grids.Count);
+                        Assert.AreEqual(cl[0].Grids.Count, cl.Grids.Count);
+                        Assert.IsFalse(string.IsNullOrEmpty(cl[0].Grids[0].ShortName));
 
                         Assert.AreEqual(new PPoint(50.999, 4.0), t.Apply(new PPoint(51, 4)).RoundXY(3));
                         var r = t.Apply(51, 4, 0);
@@ -501,9 +829,86 @@ namespace SharpProj.Tests
                         Assert.AreEqual(4.0, Math.Round(r1[1], 3));
 
                         Assert.IsNotNull(cl[0].MethodName);
+
+                        // Depending on the caches the grid may not need any request here; NetworkTests.IOStatistics checks the values
+                        var stats = pc.IOStatistics;
+                        Assert.AreEqual(ProjIOStatistics.LatencyBucketLimits.Length, stats.LatencyHistogram.Length);
+                        Assert.AreEqual(stats.Requests, stats.LatencyHistogram.Sum());
+                        Assert.IsTrue(ProjNetwork.GetStatistics().Reads >= stats.Reads);
+                    }
+                }
+            }
+        }
+
+        [TestMethod]
+        public void PrefetchGrids()
+        {
+            string userDir = Path.GetDirectoryName(ProjContext.DefaultProjDBPath);
+            string gridFile = null;
+            bool existed = false;
+
+            try
+            {
+                using (var pc = new ProjContext())
+                {
+                    pc.SetGridCache(false, null, 0, 0);
+                    pc.AllowNetworkConnections = true;
+                    pc.EndpointUrl = ProjContext.DefaultEndpointUrl;
+
+                    using (var crsAmersfoort = CoordinateReferenceSystem.Create(@"EPSG:4289", pc))
+                    using (var crsETRS89 = CoordinateReferenceSystem.Create(@"EPSG:4258", pc))
+                    using (var t = CoordinateTransform.Create(crsAmersfoort, crsETRS89))
+                    {
+                        var grid = t.Grids.First();
+                        gridFile = Path.Combine(userDir, grid.ShortName);
+                        existed = File.Exists(gridFile);
+
+                        Assert.IsTrue(t.PrefetchGrids(new CoordinateArea(3.5, 50.5, 7.5, 54)));
+                        Assert.IsTrue(File.Exists(gridFile), "Downloaded into the user directory");
+                        Assert.AreEqual(new PPoint(50.999, 4.0), t.Apply(new PPoint(51, 4)).RoundXY(3));
                     }
                 }
             }
+            finally
+            {
+                // Don't leave the grid behind, as other tests expect it to be read via the network
+                if (gridFile != null && !existed && File.Exists(gridFile))
+                {
+                    ProjContext.ClearFileCache();
+                    GC.Collect();
+                    GC.WaitForPendingFinalizers();
+                    File.Delete(gridFile);
+                }
+            }
+        }
+
+        [TestMethod]
+        public void ApplyGenericMatchesApply()
+        {
+            using (var pc = new ProjContext())
+            using (var t = (CoordinateTransform)pc.Create("+proj=helmert +x=0 +dx=0.1 +t_epoch=2000")) // Time dependent
+            {
+                double[] x = { 1000, 1100, 1200 };
+                double[] y = { 2000, 2100, 2200 };
+                double[] z = { 0, 10, 20 };
+                double[] expected = x.Select((_, i) => t.Apply(x[i], y[i], z[i])[0]).ToArray();
+
+                Assert.AreEqual(800, expected[0], 0.0001, "Epoch 0");
+
+                // Without t both paths use epoch 0
+                var bx = (double[])x.Clone();
+                var by = (double[])y.Clone();
+                var bz = (double[])z.Clone();
+                t.ApplyGeneric(bx, 0, 1, by, 0, 1, bz, 0, 1, null, 0, 0, x.Length);
+                CollectionAssert.AreEqual(expected, bx);
+
+                // And with explicit t
+                double[] epochs = { 2010, 2020, 2030 };
+                bx = (double[])x.Clone();
+                by = (double[])y.Clone();
+                t.ApplyGeneric(bx, 0, 1, by, 0, 1, null, 0, 0, epochs, 0, 1, x.Length);
+                CollectionAssert.AreEqual(x.Select((_, i) => t.Apply(x[i], y[i], 0, epochs[i])[0]).ToArray(), bx);
+            }
         }
 
         [TestMethod]
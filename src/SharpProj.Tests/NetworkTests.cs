@@ -0,0 +1,489 @@
+﻿using System;
+using System.Diagnostics;
+using System.IO;
+using System.IO.Compression;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+
+namespace SharpProj.Tests
+{
+    [TestClass]
+    public class NetworkTests
+    {
+        public TestContext TestContext { get; set; }
+
+        TimeSpan _timeout, _retryDelay, _breakerDuration;
+        int _maxRetries, _breakerThreshold, _maxReadAhead;
+        long _chunkCacheSize;
+
+        [TestInitialize]
+        public void SaveSettings()
+        {
+            _timeout = ProjNetwork.Timeout;
+            _retryDelay = ProjNetwork.BaseRetryDelay;
+            _breakerDuration = ProjNetwork.CircuitBreakerDuration;
+            _maxRetries = ProjNetwork.MaxRetries;
+            _breakerThreshold = ProjNetwork.CircuitBreakerThreshold;
+            _maxReadAhead = ProjNetwork.MaxReadAheadSize;
+            _chunkCacheSize = ProjNetwork.ChunkCacheSize;
+
+            ProjNetwork.BaseRetryDelay = TimeSpan.FromMilliseconds(10);
+        }
+
+        [TestCleanup]
+        public void RestoreSettings()
+        {
+            ProjNetwork.Timeout = _timeout;
+            ProjNetwork.BaseRetryDelay = _retryDelay;
+            ProjNetwork.CircuitBreakerDuration = _breakerDuration;
+            ProjNetwork.MaxRetries = _maxRetries;
+            ProjNetwork.CircuitBreakerThreshold = _breakerThreshold;
+            ProjNetwork.MaxReadAheadSize = _maxReadAhead;
+            ProjNetwork.ChunkCacheSize = _chunkCacheSize;
+        }
+
+        const int GridRows = 1000, GridColumns = 1000;
+        static byte[] _grid;
+
+        // Serves a 4 MB grid under a name that is new to the (process wide) caches of PROJ
+        static string AddGrid(TestHttpServer server)
+        {
+            string name = "sharpproj-" + Guid.NewGuid().ToString("N") + ".gtx";
+
+            server.Add(name, _grid ?? (_grid = TestGrid.CreateGtx(GridRows, GridColumns)));
+            return name;
+        }
+
+        // A context that reads grids only from the server
+        static ProjContext CreateContext(string endpoint)
+        {
+            var pc = new ProjContext();
+            pc.SetGridCache(false, null, 0, 0);
+            pc.AllowNetworkConnections = true;
+            pc.EndpointUrl = endpoint;
+            return pc;
+        }
+
+        // Transforms a point on row of grid, and checks the result
+        static bool TryTransform(ProjContext pc, string grid, int row = 10)
+        {
+            try
+            {
+                using (var t = TestGrid.CreateVerticalTransform(pc, grid))
+                {
+                    var r = t.Apply(TestGrid.GtxLon + 0.5, TestGrid.GtxLat + row * TestGrid.GtxSpacing, 0);
+
+                    if (double.IsInfinity(r[2]))
+                        return false;
+
+                    Assert.AreEqual(row, r[2], 0.0001);
+                    return true;
+                }
+            }
+            catch (ProjException)
+            {
+                return false;
+            }
+        }
+
+        static string ProjDBFile
+        {
+            get
+            {
+                string dbFile = Path.Combine(AppDomain.CurrentDomain.BaseDirectory, "proj.db");
+
+                if (!File.Exists(dbFile))
+                    Assert.Inconclusive("proj.db not found");
+
+                return dbFile;
+            }
+        }
+
+        // A package laid out like SharpProj.Database
+        static byte[] CreateProjDBPackage()
+        {
+            using (var ms = new MemoryStream())
+            {
+                using (var za = new ZipArchive(ms, ZipArchiveMode.Create, true))
+                using (var to = za.CreateEntry("contentFiles/any/any/proj.db").Open())
+                using (var from = File.OpenRead(ProjDBFile))
+                {
+                    from.CopyTo(to);
+                }
+                return ms.ToArray();
+            }
+        }
+
+        static string DownloadProjDB(TestHttpServer server, string target, CancellationToken cancellationToken = default(CancellationToken))
+        {
+            string oldUrl = ProjNetwork.ProjDBPackageUrl;
+            ProjNetwork.ProjDBPackageUrl = server.Url + "/proj.nupkg";
+            try
+            {
+                return ProjContext.DownloadProjDBAsync(target, null, cancellationToken).GetAwaiter().GetResult();
+            }
+            finally
+            {
+                ProjNetwork.ProjDBPackageUrl = oldUrl;
+            }
+        }
+
+        // Transforms points from south to north, so PROJ reads the grid front to back. Returns the number of requests for it
+        static int Sweep(TestHttpServer server, string grid)
+        {
+            using (var pc = CreateContext(server.Url))
+            using (var t = TestGrid.CreateVerticalTransform(pc, grid))
+            {
+                for (int r = 0; r < GridRows - 1; r += 2)
+                {
+                    foreach (int c in new[] { 0, GridColumns / 2, GridColumns - 2 })
+                    {
+                        var p = t.Apply(TestGrid.GtxLon + c * TestGrid.GtxSpacing, TestGrid.GtxLat + r * TestGrid.GtxSpacing, 0);
+                        Assert.AreEqual(r, p[2], 0.0001);
+                    }
+                }
+            }
+
+            return server.Requests.Count(x => x.Path == "/" + grid);
+        }
+
+        [TestMethod]
+        public void TransformsViaHandler()
+        {
+            ProjNetwork.ChunkCacheSize = 0;
+            ProjNetwork.MaxReadAheadSize = 0;
+
+            using (var server = new TestHttpServer())
+            using (var pc = CreateContext(server.Url))
+            {
+                string grid = AddGrid(server);
+
+                foreach (int row in new[] { 0, GridRows / 2, GridRows - 2 })
+                    Assert.IsTrue(TryTransform(pc, grid, row));
+
+                var rq = server.Requests;
+                Assert.IsTrue(rq.Count >= 3, $"{rq.Count} requests");
+                Assert.IsTrue(rq.All(x => x.Path == "/" + grid && x.Status == 206 && x.Range.StartsWith("bytes=")));
+                Assert.IsTrue(rq.All(x => x.UserAgent.Contains("SharpProj")));
+                Assert.IsTrue(rq.Select(x => x.Connection).Distinct().Count() < rq.Count, "Connections are reused");
+                Assert.AreEqual(rq.Count, pc.IOStatistics.Requests);
+            }
+        }
+
+        [TestMethod]
+        public void IOStatistics()
+        {
+            using (var server = new TestHttpServer())
+            using (var pc = CreateContext(server.Url))
+            {
+                server.Delay = TimeSpan.FromMilliseconds(50);
+                long processRequests = ProjNetwork.GetStatistics().Requests;
+
+                Assert.IsTrue(TryTransform(pc, AddGrid(server)));
+
+                var stats = pc.IOStatistics;
+                Assert.IsTrue(stats.Requests >= 1);
+                Assert.AreEqual(server.RequestCount, stats.Requests);
+                Assert.IsTrue(stats.Reads >= 1);
+                Assert.IsTrue(stats.BytesReceived >= 16384, $"{stats.BytesReceived} bytes");
+                Assert.IsTrue(stats.BlockedTime >= TimeSpan.FromMilliseconds(40), $"Blocked {stats.BlockedTime}");
+                Assert.AreEqual(0, stats.Failures);
+                Assert.AreEqual(0, stats.LocalReads);
+                Assert.AreEqual(stats.Requests, stats.LatencyHistogram.Sum());
+                Assert.IsTrue(ProjNetwork.GetStatistics().Requests - processRequests >= stats.Requests);
+            }
+        }
+
+        [TestMethod]
+        public void ReadAheadReducesRequests()
+        {
+            using (var server = new TestHttpServer())
+            {
+                ProjNetwork.ChunkCacheSize = 0;
+                ProjNetwork.MaxReadAheadSize = 0;
+                int exact = Sweep(server, AddGrid(server));
+
+                ProjNetwork.MaxReadAheadSize = 1024 * 1024;
+                long hits = ProjNetwork.GetStatistics().ReadAheadHits;
+                int ahead = Sweep(server, AddGrid(server));
+
+                // 4 MB read in 16 KB chunks, against ranges doubling up to 1 MB
+                Assert.IsTrue(exact >= 200, $"{exact} requests without read-ahead");
+                Assert.IsTrue(ahead <= 20, $"{ahead} requests with read-ahead");
+                Assert.IsTrue(ProjNetwork.GetStatistics().ReadAheadHits > hits);
+            }
+        }
+
+        [TestMethod]
+        public void ConcurrentReadsShareRequests()
+        {
+            using (var server = new TestHttpServer())
+            using (var barrier = new Barrier(2))
+            {
+                string grid = AddGrid(server);
+                server.Delay = TimeSpan.FromMilliseconds(300); // Keeps the first request in flight while the other context asks
+                var before = ProjNetwork.GetStatistics();
+                long misses = ProjNetwork.ChunkCacheMisses;
+
+                Parallel.For(0, 2, new ParallelOptions { MaxDegreeOfParallelism = 2 }, i =>
+                {
+                    using (var pc = CreateContext(server.Url))
+                    {
+                        barrier.SignalAndWait();
+                        Assert.IsTrue(TryTransform(pc, grid, row: 0)); // Only needs the first 16 KB
+                    }
+                });
+
+                Assert.AreEqual(2, ProjNetwork.GetStatistics().Reads - before.Reads, "Both contexts read");
+                Assert.AreEqual(1, server.RequestCount, "Single request");
+                Assert.AreEqual(1, ProjNetwork.ChunkCacheMisses - misses);
+            }
+        }
+
+        [TestMethod]
+        public void ChunkCacheEvicts()
+        {
+            ProjNetwork.ChunkCacheSize = 16 * 1024;
+            ProjNetwork.MaxReadAheadSize = 0;
+            long evictions = ProjNetwork.ChunkCacheEvictions;
+
+            using (var server = new TestHttpServer())
+            using (var pc = CreateContext(server.Url))
+            {
+                // Every grid adds a 16 KB range, replacing the one before it
+                for (int i = 0; i < 3; i++)
+                    Assert.IsTrue(TryTransform(pc, AddGrid(server), row: 0));
+            }
+
+            Assert.IsTrue(ProjNetwork.ChunkCacheEvictions - evictions >= 2);
+            Assert.IsTrue(ProjNetwork.ChunkCacheBytes <= 16 * 1024);
+        }
+
+        [TestMethod]
+        public void RetriesTransientFailures()
+        {
+            using (var server = new TestHttpServer())
+            using (var pc = CreateContext(server.Url))
+            {
+                ProjNetwork.MaxRetries = 3;
+                server.FailNext(2);
+
+                Assert.IsTrue(TryTransform(pc, AddGrid(server)));
+
+                var rq = server.Requests;
+                Assert.AreEqual(503, rq[0].Status);
+                Assert.AreEqual(503, rq[1].Status);
+                Assert.AreEqual(206, rq[2].Status);
+                Assert.AreEqual(2, pc.IOStatistics.Retries);
+                Assert.AreEqual(0, pc.IOStatistics.Failures);
+            }
+        }
+
+        [TestMethod]
+        public void TimesOutStalledRequests()
+        {
+            using (var server = new TestHttpServer())
+            using (var pc = CreateContext(server.Url))
+            {
+                ProjNetwork.Timeout = TimeSpan.FromMilliseconds(250);
+                ProjNetwork.MaxRetries = 0;
+                server.StallNext(int.MaxValue, TimeSpan.FromSeconds(10));
+
+                var sw = Stopwatch.StartNew();
+                Assert.IsFalse(TryTransform(pc, AddGrid(server)));
+                Assert.IsTrue(sw.Elapsed < TimeSpan.FromSeconds(5), "Gave up after the timeout");
+                Assert.IsTrue(pc.IOStatistics.Failures >= 1);
+
+                // A retry after the timeout succeeds
+                ProjNetwork.MaxRetries = 1;
+                server.StallNext(1, TimeSpan.FromSeconds(10));
+                long retries = pc.IOStatistics.Retries;
+
+                Assert.IsTrue(TryTransform(pc, AddGrid(server)));
+                Assert.AreEqual(retries + 1, pc.IOStatistics.Retries);
+            }
+        }
+
+        [TestMethod]
+        public void CircuitBreakerOpensAndRecovers()
+        {
+            using (var server = new TestHttpServer())
+            using (var pc = CreateContext(server.Url))
+            {
+                ProjNetwork.MaxRetries = 0;
+                ProjNetwork.CircuitBreakerThreshold = 2;
+                ProjNetwork.CircuitBreakerDuration = TimeSpan.FromMilliseconds(500);
+
+                // Closed: failures reach the server until the threshold is hit
+                server.FailNext(int.MaxValue);
+                Assert.IsFalse(TryTransform(pc, AddGrid(server)));
+                Assert.IsFalse(TryTransform(pc, AddGrid(server)));
+                int failed = server.RequestCount;
+                Assert.IsTrue(failed >= 2);
+
+                // Open: requests fail without reaching the server
+                Assert.IsFalse(TryTransform(pc, AddGrid(server)));
+                Assert.AreEqual(failed, server.RequestCount);
+
+                // After the duration a single trial request is made. When that fails the breaker opens again
+                Thread.Sleep(600);
+                server.FailNext(1);
+                Assert.IsFalse(TryTransform(pc, AddGrid(server)));
+                Assert.AreEqual(failed + 1, server.RequestCount, "Single trial request");
+                Assert.IsFalse(TryTransform(pc, AddGrid(server)));
+                Assert.AreEqual(failed + 1, server.RequestCount, "Open again");
+
+                // A successful trial closes it
+                Thread.Sleep(600);
+                Assert.IsTrue(TryTransform(pc, AddGrid(server)));
+                Assert.IsTrue(TryTransform(pc, AddGrid(server)));
+            }
+        }
+
+        [TestMethod]
+        public void LocalMirror()
+        {
+            using (var dir = TestGrid.CreateTempDirectory())
+            {
+                string grid = "sharpproj-" + Guid.NewGuid().ToString("N") + ".gtx";
+                byte[] data = TestGrid.CreateGtx(GridRows, GridColumns);
+                File.WriteAllBytes(Path.Combine(dir.Path, grid), data);
+
+                foreach (string endpoint in new[] { dir.Path, new Uri(dir.Path).AbsoluteUri })
+                {
+                    using (var pc = CreateContext(endpoint))
+                    {
+                        var log = new System.Collections.Concurrent.ConcurrentQueue<string>();
+                        pc.Log += (_, x) => log.Enqueue(x);
+
+                        Assert.AreEqual(dir.Path, pc.EndpointUrl);
+                        Assert.IsTrue(TryTransform(pc, grid));
+                        Assert.IsTrue(pc.IOStatistics.LocalReads > 0);
+                        Assert.AreEqual(0, pc.IOStatistics.Requests);
+                        Assert.IsTrue(log.Any(x => x.Contains("Content-Range: bytes 0-16383/" + data.Length)), "Synthesized Content-Range");
+
+                        Assert.IsFalse(TryTransform(pc, "sharpproj-missing-" + Guid.NewGuid().ToString("N") + ".gtx"));
+                        Assert.IsTrue(log.Any(x => x.Contains("Not found in local mirror")));
+                    }
+                }
+            }
+        }
+
+        [TestMethod]
+        public void DownloadProjDBResumes()
+        {
+            byte[] package = CreateProjDBPackage();
+
+            using (var server = new TestHttpServer())
+            using (var dir = TestGrid.CreateTempDirectory())
+            {
+                server.Add("proj.nupkg", package);
+                string target = Path.Combine(dir.Path, "proj.db");
+
+                // What an interrupted earlier attempt leaves behind
+                File.WriteAllBytes(target + ".nupkg.part", package.Take(package.Length / 2).ToArray());
+                File.WriteAllText(target + ".nupkg.part.etag", server.GetETag("proj.nupkg"));
+
+                Assert.AreEqual(target, DownloadProjDB(server, target));
+
+                var rq = server.Requests.Single();
+                Assert.AreEqual("bytes=" + (package.Length / 2) + "-", rq.Range);
+                Assert.AreEqual(server.GetETag("proj.nupkg"), rq.IfRange);
+                Assert.AreEqual(206, rq.Status);
+
+                Assert.AreEqual(new FileInfo(ProjDBFile).Length, new FileInfo(target).Length);
+                Assert.IsFalse(File.Exists(target + ".nupkg.part"));
+                Assert.IsFalse(File.Exists(target + ".lock"));
+            }
+        }
+
+        [TestMethod]
+        public void DownloadProjDBRestartsChangedPackage()
+        {
+            byte[] package = CreateProjDBPackage();
+
+            using (var server = new TestHttpServer())
+            using (var dir = TestGrid.CreateTempDirectory())
+            {
+                server.Add("proj.nupkg", package);
+                string target = Path.Combine(dir.Path, "proj.db");
+
+                // Part of an older version of the package
+                File.WriteAllBytes(target + ".nupkg.part", new byte[package.Length / 2]);
+                File.WriteAllText(target + ".nupkg.part.etag", "\"older\"");
+
+                DownloadProjDB(server, target);
+
+                Assert.AreEqual(200, server.Requests.Single().Status, "Whole package sent");
+                Assert.AreEqual(new FileInfo(ProjDBFile).Length, new FileInfo(target).Length);
+            }
+        }
+
+        [TestMethod]
+        public void DownloadProjDBRejectsCorruptPackage()
+        {
+            using (var server = new TestHttpServer())
+            using (var dir = TestGrid.CreateTempDirectory())
+            {
+                byte[] garbage = new byte[64 * 1024];
+                new Random(42).NextBytes(garbage);
+                server.Add("proj.nupkg", garbage);
+                string target = Path.Combine(dir.Path, "proj.db");
+
+                Assert.ThrowsException<InvalidDataException>(() => DownloadProjDB(server, target));
+
+                Assert.IsFalse(File.Exists(target));
+                Assert.IsFalse(File.Exists(target + ".nupkg.part"), "Corrupt package not resumed");
+                Assert.IsFalse(File.Exists(target + ".tmp"));
+            }
+        }
+
+        [TestMethod]
+        public void DownloadProjDBWaitsForLock()
+        {
+            string oldUrl = ProjNetwork.ProjDBPackageUrl;
+
+            using (var server = new TestHttpServer())
+            using (var dir = TestGrid.CreateTempDirectory())
+            using (var cts = new CancellationTokenSource())
+            {
+                server.Add("proj.nupkg", CreateProjDBPackage());
+                string target = Path.Combine(dir.Path, "proj.db");
+                ProjNetwork.ProjDBPackageUrl = server.Url + "/proj.nupkg";
+                try
+                {
+                    Task<string> first;
+                    Task<string> second;
+
+                    // As held by another process
+                    using (new FileStream(target + ".lock", FileMode.OpenOrCreate, FileAccess.ReadWrite, FileShare.None))
+                    {
+                        first = ProjContext.DownloadProjDBAsync(target, null, cts.Token);
+                        second = ProjContext.DownloadProjDBAsync(target, null, CancellationToken.None);
+
+                        Thread.Sleep(750);
+                        Assert.IsFalse(first.IsCompleted);
+                        Assert.IsFalse(second.IsCompleted);
+                        Assert.AreEqual(0, server.RequestCount, "Waits for the lock");
+
+                        // Cancelling one waiter doesn't cancel the shared download
+                        cts.Cancel();
+                        Assert.IsTrue(first.ContinueWith(_ => { }).Wait(5000));
+                        Assert.IsTrue(first.IsCanceled);
+                        Assert.IsFalse(second.IsCompleted);
+                    }
+
+                    Assert.AreEqual(target, second.GetAwaiter().GetResult());
+                    Assert.AreEqual(1, server.RequestCount);
+                    Assert.IsTrue(File.Exists(target));
+                }
+                finally
+                {
+                    ProjNetwork.ProjDBPackageUrl = oldUrl;
+                }
+            }
+        }
+    }
+}
@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Linq;
 using Microsoft.VisualStudio.TestTools.UnitTesting;
 using NetTopologySuite.Geometries;
 using SharpProj.NTS;
@@ -13,6 +14,7 @@ namespace SharpProj.Tests
         {
             Netherlands = 28992,
             BelgiumLambert = 3812,
+            EuropeLaea = 3035,
 
             AnotherNL
         }
@@ -22,6 +24,7 @@ namespace SharpProj.Tests
         {
             SridRegister.Ensure(Epsg.Netherlands, () => CoordinateReferenceSystem.Create("EPSG:28992"), (int)Epsg.Netherlands);
             SridRegister.Ensure(Epsg.BelgiumLambert, () => CoordinateReferenceSystem.Create("EPSG:3812"), (int)Epsg.BelgiumLambert);
+            SridRegister.Ensure(Epsg.EuropeLaea, () => CoordinateReferenceSystem.Create("EPSG:3035"), (int)Epsg.EuropeLaea);
             SridRegister.Ensure(Epsg.AnotherNL, () => CoordinateReferenceSystem.Create("EPSG:28992"), (int)Epsg.AnotherNL); // Different EPSG, same definition. Ok. But can't use same CRS instance
         }
 
@@ -111,8 +114,39 @@ namespace SharpProj.Tests
 
 
 
+            // Clearly within and clearly beyond the limit; decided by the scale bounds alone
+            var sb = typeof(SridItem).GetProperty("ScaleBounds", System.Reflection.BindingFlags.Instance | System.Reflection.BindingFlags.NonPublic).GetValue(srid);
+            Assert.IsNotNull(sb);
+            double minScale = (double)sb.GetType().GetProperty("MinScale").GetValue(sb);
+            double maxScale = (double)sb.GetType().GetProperty("MaxScale").GetValue(sb);
+            double ratio = t1.Distance(t2) / t1.MeterDistance(t2).Value;
+            Assert.IsTrue(minScale <= ratio && ratio <= maxScale, $"{ratio} within [{minScale}, {maxScale}]");
+
+            Assert.IsTrue(t1.Coordinate.Distance(t2.Coordinate) / minScale <= 100000, "Fast path within");
+            Assert.IsTrue(t1.IsWithinMeterDistance(t2, 100000).Value);
+            Assert.IsTrue(t1.EnvelopeInternal.Distance(t2.EnvelopeInternal) / maxScale > 50000, "Fast path beyond");
+            Assert.IsFalse(t1.IsWithinMeterDistance(t2, 50000).Value);
+            Assert.IsFalse(t2.IsWithinMeterDistance(t1, 1000).Value);
+
             Assert.IsTrue(t1.IsWithinMeterDistance(t2, 70000).Value);
             Assert.IsFalse(t2.IsWithinMeterDistance(t1, 64000).Value);
+            Assert.IsTrue(t1.IsWithinMeterDistance(t2, 65913.7).Value); // Too close to decide via the scale bounds
+            Assert.IsFalse(t1.IsWithinMeterDistance(t2, 65913.5).Value);
+
+            // Around the threshold the answer must match the exact distance, whether the scale bounds decide or the geodesic does
+            double exact = t1.MeterDistance(t2).Value;
+            double planar = t1.Distance(t2);
+            int viaBounds = 0, total = 0;
+            for (double f = -0.05; f <= 0.05; f += 0.0025, total++)
+            {
+                double limit = exact * (1 + f);
+
+                Assert.AreEqual(exact <= limit, t1.IsWithinMeterDistance(t2, limit).Value, $"Limit {limit}");
+
+                if (planar / minScale <= limit || planar / maxScale > limit)
+                    viaBounds++;
+            }
+            Assert.IsTrue(viaBounds > 0 && viaBounds < total, $"{viaBounds} of {total} decided via the scale bounds");
 
 
             Assert.IsTrue(t1.Centroid.Coordinate.Equals3D(t1.Centroid.Coordinate));
@@ -125,8 +159,200 @@ namespace SharpProj.Tests
 
             Assert.AreEqual(4330957964.64, Math.Round(t3.MeterArea().Value, 2)); // Not using backing data yet
 
+            var metrics = t3.GeoMetrics().Value;
+            Assert.AreEqual(4330957964.64, Math.Round(metrics.Area, 2));
+            Assert.AreEqual(300024.180, Math.Round(metrics.Length, 3));
+
+            var mp = srid.Factory.CreateMultiPolygon(new[] { t1, t2, t3 });
+            var mpMetrics = mp.GeoMetrics().Value;
+            Assert.AreEqual(Math.Round(t1.MeterArea().Value + t2.MeterArea().Value + t3.MeterArea().Value, 2), Math.Round(mpMetrics.Area, 2));
+            Assert.AreEqual(Math.Round(t1.MeterLength().Value + t2.MeterLength().Value + t3.MeterLength().Value, 3), Math.Round(mpMetrics.Length, 3));
+
+
+
+        }
+
+        [TestMethod]
+        public void NtsEqualArea()
+        {
+            Assert.IsTrue(double.IsNaN(SridRegister.GetById(Epsg.Netherlands).CRS.DistanceTransform.EqualAreaFactor));
+
+            var srid = SridRegister.GetById(Epsg.EuropeLaea);
+            var dt = srid.CRS.DistanceTransform;
+
+            Assert.AreEqual(1.0, Math.Abs(dt.EqualAreaFactor));
+
+            // 1 km2 parcel near Amersfoort
+            var parcel = CreateTriangle(srid.Factory, new Coordinate(3210000, 3980000), 1000);
+
+            using (var geo = srid.CRS.GeodeticCRS.WithAxisNormalized())
+            using (var t = CoordinateTransform.Create(srid.CRS, geo))
+            double geodesic = Math.Abs(geo.DistanceTransform.GeoArea(parcel.Coordinates.Select(c => t.Apply(c.ToPPoint()))));
+
+            Assert.AreEqual(parcel.Area, parcel.MeterArea().Value, 0.0001);
+            Assert.AreEqual(geodesic, parcel.MeterArea().Value, geodesic * 1e-6);
+        }
+
+        [TestMethod]
+        public void PlanarDistance()
+        {
+            var srid = SridRegister.GetById(Epsg.Netherlands);
+
+            var dt = srid.CRS.DistanceTransform;
+            PPoint amersfoortRD = new PPoint(155000, 463000);
+
+            foreach (var p in new[] { amersfoortRD.Offset(1000, 0), amersfoortRD.Offset(-2500, 3000), amersfoortRD.Offset(0, 4000) })
+            {
+                Assert.AreEqual(dt.GeoDistance(amersfoortRD, p), dt.GeoDistance(amersfoortRD, p, 5000), 0.001);
+            }
+
+            // Longer segments use the exact calculation
+            PPoint far = amersfoortRD.Offset(50000, 50000);
+            Assert.AreEqual(dt.GeoDistance(amersfoortRD, far), dt.GeoDistance(amersfoortRD, far, 5000));
+        }
+
+        [TestMethod]
+        public void ReprojectReusesTransform()
+        {
+            var nl = SridRegister.GetById(Epsg.Netherlands);
+            var be = SridRegister.GetById(Epsg.BelgiumLambert);
+            var points = Enumerable.Range(0, 200).Select(i => nl.Factory.CreatePoint(new Coordinate(150000 + i * 100, 460000 + i * 50))).ToArray();
+
+            using (var t = CoordinateTransform.Create(nl, be))
+            {
+                var expected = points.Select(p => t.Apply(p.Coordinate).RoundAll(3)).ToArray();
+                var result = new Coordinate[points.Length];
+
+                object pool = GetTransformPool(nl, be);
+                System.Threading.Tasks.Parallel.For(0, points.Length, i => result[i] = points[i].Reproject(be).Coordinate.RoundAll(3));
+
+                CollectionAssert.AreEqual(expected, result);
+                Assert.AreSame(pool, GetTransformPool(nl, be), "Operation resolved once");
+
+                // A returned transform is handed out again, instead of a new clone
+                var rented = PoolCall(pool, "Rent");
+                PoolCall(pool, "Return", rented);
+                Assert.AreSame(rented, PoolCall(pool, "Rent"));
+                PoolCall(pool, "Return", rented);
+
+                nl.ClearTransformCache();
+                Assert.AreNotSame(pool, GetTransformPool(nl, be));
+                Assert.AreEqual(expected[0], points[0].Reproject(be).Coordinate.RoundAll(3));
+
+                // A pool disposed by ClearTransformCache while in use still hands out working transforms
+                var late = (CoordinateTransform)PoolCall(pool, "Rent");
+                Assert.AreEqual(expected[0], late.Apply(points[0].Coordinate).RoundAll(3));
+                PoolCall(pool, "Return", late);
+            }
+        }
 
+        // The pool behind Reproject is internal to SharpProj.NetTopologySuite
+        static object GetTransformPool(SridItem from, SridItem to)
+        {
+            return typeof(SridItem).GetMethod("GetTransformPool", System.Reflection.BindingFlags.Instance | System.Reflection.BindingFlags.NonPublic)
+                .Invoke(from, new object[] { to });
+        }
 
+        static object PoolCall(object pool, string method, params object[] args)
+        {
+            return pool.GetType().GetMethod(method).Invoke(pool, args);
+        }
+
+        [TestMethod]
+        public void ReprojectSequences()
+        {
+            var nl = SridRegister.GetById(Epsg.Netherlands);
+            var be = SridRegister.GetById(Epsg.BelgiumLambert);
+            double[] xyz = { 155000, 463000, 10, 156000, 464000, double.NaN, 157000, 465000, 30 };
+
+            using (var t = CoordinateTransform.Create(nl, be))
+            {
+                var packed = new NetTopologySuite.Geometries.Implementation.PackedDoubleCoordinateSequence(xyz, 3, 0);
+                var packedFactory = new NetTopologySuite.Geometries.Implementation.PackedCoordinateSequenceFactory();
+                var arrayFactory = NetTopologySuite.Geometries.Implementation.CoordinateArraySequenceFactory.Instance;
+
+                var r1 = t.Apply(packed, packedFactory);
+                var r2 = t.Apply(packed, arrayFactory);
+
+                Assert.IsInstanceOfType(r1, typeof(NetTopologySuite.Geometries.Implementation.PackedDoubleCoordinateSequence));
+                Assert.AreEqual(3, r1.Count);
+                Assert.AreEqual(155000, xyz[0], "Source not modified");
+                Assert.IsTrue(double.IsNaN(r1.GetZ(1)), "Missing Z stays missing");
+
+                for (int i = 0; i < packed.Count; i++)
+                {
+                    var expected = t.Apply(new Coordinate(packed.GetX(i), packed.GetY(i))).RoundAll(3);
+
+                    Assert.AreEqual(expected, new Coordinate(r1.GetX(i), r1.GetY(i)).RoundAll(3));
+                    Assert.AreEqual(expected, new Coordinate(r2.GetX(i), r2.GetY(i)).RoundAll(3));
+                }
+            }
+        }
+
+        [TestMethod]
+        public void ReprojectParallel()
+        {
+            var nl = SridRegister.GetById(Epsg.Netherlands);
+            var be = SridRegister.GetById(Epsg.BelgiumLambert);
+            var parcels = Enumerable.Range(0, 5000).Select(i => (Geometry)CreateTriangle(nl.Factory, new Coordinate(100000 + i * 20, 400000 + i * 10), 50)).ToArray();
+            parcels[10] = null;
+
+            var parallel = parcels.ReprojectParallel(be);
+            var serial = parcels.Select(p => p?.Reproject(be)).ToArray();
+
+            Assert.AreEqual(parcels.Length, parallel.Length);
+            Assert.IsNull(parallel[10]);
+            for (int i = 0; i < parcels.Length; i++)
+            {
+                if (serial[i] != null)
+                    Assert.IsTrue(serial[i].EqualsExact(parallel[i], 0.0001), $"Item {i}");
+            }
+
+            var mp = nl.Factory.CreateMultiPolygon(parcels.Where(p => p != null).Cast<Polygon>().ToArray());
+            var r = mp.Reproject(be);
+            Assert.IsInstanceOfType(r, typeof(MultiPolygon));
+            Assert.AreEqual(be.SRID, r.SRID);
+            Assert.IsTrue(r.GetGeometryN(0).EqualsExact(serial[0], 0.0001));
+
+            // Parts built by another factory (SRID 0) use the SRID of the collection, as on the serial path
+            var plain = new GeometryFactory();
+            var mp0 = nl.Factory.CreateMultiPolygon(parcels.Where(p => p != null).Select(p => (Polygon)plain.CreateGeometry(p)).ToArray());
+            Assert.AreEqual(0, mp0.GetGeometryN(0).SRID);
+            var r0 = mp0.Reproject(be);
+            Assert.AreEqual(be.SRID, r0.SRID);
+            Assert.IsTrue(r0.EqualsExact(r, 0.0001));
+        }
+
+        [TestMethod]
+        public void NtsGeoIndex()
+        {
+            var srid = SridRegister.GetById(Epsg.Netherlands);
+            var rnd = new Random(42);
+            var coords = new Coordinate[2000];
+
+            for (int i = 0; i < coords.Length; i++)
+                coords[i] = new Coordinate(20000 + rnd.NextDouble() * 250000, 310000 + rnd.NextDouble() * 300000);
+
+            using (var index = srid.CreateGeoIndex(coords))
+            using (var dt = srid.CRS.DistanceTransform.Clone())
+            {
+                Assert.AreEqual(coords.Length, index.Count);
+
+                Coordinate q = new Coordinate(155000, 463000);
+                var nearest = index.Nearest(q, 5);
+                var expected = coords.Select((c, i) => new { i, d = dt.GeoDistance(q, c) }).OrderBy(x => x.d).Take(5).ToArray();
+
+                Assert.AreEqual(5, nearest.Length);
+                for (int i = 0; i < nearest.Length; i++)
+                {
+                    Assert.AreEqual(expected[i].i, nearest[i].Index);
+                    Assert.AreEqual(expected[i].d, nearest[i].Distance, 0.001);
+                }
+
+                var within = index.WithinDistance(q, 20000);
+                Assert.AreEqual(coords.Count(c => dt.GeoDistance(q, c) <= 20000), within.Length);
+                Assert.IsTrue(within.All(x => x.Distance <= 20000));
+            }
         }
 
     }
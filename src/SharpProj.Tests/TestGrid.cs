@@ -0,0 +1,160 @@
+﻿using System;
+using System.IO;
+using System.Net;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+
+namespace SharpProj.Tests
+{
+    /// <summary>
+    /// Local copy of a real grid, for tests that must not depend on what PROJ finds (or caches) on this machine
+    /// </summary>
+    static class TestGrid
+    {
+        /// <summary>Horizontal grid used by Amersfoort (EPSG:4289) to ETRS89 (EPSG:4258)</summary>
+        public const string Name = "nl_nsgi_rdtrans2018.tif";
+
+        /// <summary>
+        /// Creates an operation that applies grid <paramref name="gridName"/> to longitude, latitude in degrees
+        /// </summary>
+        public static CoordinateTransform CreateTransform(ProjContext pc, string gridName)
+        {
+            return (CoordinateTransform)pc.Create("+proj=pipeline +step +proj=unitconvert +xy_in=deg +xy_out=rad"
+                + " +step +proj=hgridshift +grids=" + gridName
+                + " +step +proj=unitconvert +xy_in=rad +xy_out=deg");
+        }
+
+        /// <summary>
+        /// Creates an operation that adds the value of vertical grid <paramref name="gridName"/> to the height of
+        /// longitude, latitude in degrees
+        /// </summary>
+        public static CoordinateTransform CreateVerticalTransform(ProjContext pc, string gridName)
+        {
+            return (CoordinateTransform)pc.Create("+proj=pipeline +step +proj=unitconvert +xy_in=deg +xy_out=rad"
+                + " +step +proj=vgridshift +grids=" + gridName + " +multiplier=1"
+                + " +step +proj=unitconvert +xy_in=rad +xy_out=deg");
+        }
+
+        /// <summary>South west node of the grids created by <see cref="CreateGtx"/></summary>
+        public const double GtxLon = 3.0, GtxLat = 50.0, GtxSpacing = 0.01;
+
+        /// <summary>
+        /// Creates a vertical grid in GTX format of <paramref name="rows"/> by <paramref name="columns"/> nodes, starting at
+        /// (<see cref="GtxLon"/>, <see cref="GtxLat"/>). The value of every node is its row number.
+        /// </summary>
+        /// <remarks>PROJ reads GTX grids value by value, so a sweep from south to north reads the file sequentially</remarks>
+        public static byte[] CreateGtx(int rows, int columns)
+        {
+            byte[] data = new byte[40 + rows * columns * 4];
+            int pos = 0;
+
+            void Put(byte[] value)
+            {
+                if (BitConverter.IsLittleEndian)
+                    Array.Reverse(value); // GTX is big endian
+
+                value.CopyTo(data, pos);
+                pos += value.Length;
+            }
+
+            Put(BitConverter.GetBytes(GtxLat));
+            Put(BitConverter.GetBytes(GtxLon));
+            Put(BitConverter.GetBytes(GtxSpacing));
+            Put(BitConverter.GetBytes(GtxSpacing));
+            Put(BitConverter.GetBytes(rows));
+            Put(BitConverter.GetBytes(columns));
+
+            for (int r = 0; r < rows; r++)
+            {
+                for (int c = 0; c < columns; c++)
+                    Put(BitConverter.GetBytes((float)r));
+            }
+            return data;
+        }
+
+        static readonly object _lock = new object();
+
+        /// <summary>
+        /// Gets the path of a copy of grid <paramref name="name"/>, downloaded once from the PROJ CDN into the temp directory
+        /// </summary>
+        public static string GetPath(string name = Name)
+        {
+            string dir = Path.Combine(Path.GetTempPath(), "SharpProj.Tests", "grids");
+            string path = Path.Combine(dir, name);
+
+            lock (_lock)
+            {
+                if (File.Exists(path))
+                    return path;
+
+                Directory.CreateDirectory(dir);
+                ServicePointManager.SecurityProtocol |= SecurityProtocolType.Tls12;
+                try
+                {
+                    using (var wc = new WebClient())
+                        wc.DownloadFile(ProjContext.DefaultEndpointUrl + "/" + name, path + ".tmp");
+
+                    File.Move(path + ".tmp", path);
+                }
+                catch (WebException e)
+                {
+                    Assert.Inconclusive($"Grid {name} not available: {e.Message}");
+                }
+                return path;
+            }
+        }
+
+        /// <summary>
+        /// Creates a new directory below the temp directory, deleted by disposing the result
+        /// </summary>
+        public static TempDirectory CreateTempDirectory()
+        {
+            return new TempDirectory();
+        }
+
+        public sealed class TempDirectory : IDisposable
+        {
+            public string Path { get; } = System.IO.Path.Combine(System.IO.Path.GetTempPath(), "SharpProj.Tests", Guid.NewGuid().ToString("N"));
+
+            internal TempDirectory()
+            {
+                Directory.CreateDirectory(Path);
+            }
+
+            public void Dispose()
+            {
+                try
+                {
+                    Directory.Delete(Path, true);
+                }
+                catch (IOException)
+                {
+                    // Still mapped by a context that wasn't collected yet
+                }
+                catch (UnauthorizedAccessException)
+                {
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Sets an environment variable (e.g. PROJ_LIB, as used by the file lookup of <see cref="ProjContext"/>) until disposed
+    /// </summary>
+    sealed class EnvironmentScope : IDisposable
+    {
+        readonly string _name;
+        readonly string _old;
+
+        public EnvironmentScope(string name, string value)
+        {
+            _name = name;
+            _old = Environment.GetEnvironmentVariable(name);
+            Environment.SetEnvironmentVariable(name, value);
+        }
+
+        public void Dispose()
+        {
+            Environment.SetEnvironmentVariable(_name, _old);
+        }
+    }
+}
@@ -0,0 +1,249 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Globalization;
+using System.Net;
+using System.Net.Sockets;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace SharpProj.Tests
+{
+    /// <summary>
+    /// Minimal HTTP server on localhost that serves byte ranges of registered files, standing in for cdn.proj.org and nuget.org.
+    /// Failed and stalled responses can be injected, and all requests are recorded
+    /// </summary>
+    sealed class TestHttpServer : IDisposable
+    {
+        public sealed class Request
+        {
+            public string Path { get; set; }
+            public string Range { get; set; }
+            public string IfRange { get; set; }
+            public string UserAgent { get; set; }
+            public string Connection { get; set; }
+            public int Status { get; set; }
+        }
+
+        sealed class Resource
+        {
+            public byte[] Data;
+            public string ETag;
+            public DateTime Modified;
+        }
+
+        readonly HttpListener _listener = new HttpListener();
+        readonly ConcurrentDictionary<string, Resource> _files = new ConcurrentDictionary<string, Resource>(StringComparer.OrdinalIgnoreCase);
+        readonly ConcurrentQueue<Request> _requests = new ConcurrentQueue<Request>();
+        int _failNext;
+        int _failStatus;
+        int _stallNext;
+        TimeSpan _stallTime;
+
+        public TestHttpServer()
+        {
+            var probe = new TcpListener(IPAddress.Loopback, 0);
+            probe.Start();
+            int port = ((IPEndPoint)probe.LocalEndpoint).Port;
+            probe.Stop();
+
+            Url = "http://localhost:" + port.ToString(CultureInfo.InvariantCulture);
+            _listener.Prefixes.Add(Url + "/");
+            _listener.Start();
+
+            Task.Run(() => Listen());
+        }
+
+        /// <summary>The base url, without trailing '/'</summary>
+        public string Url { get; }
+
+        /// <summary>Time every response waits before it is sent</summary>
+        public TimeSpan Delay { get; set; }
+
+        public IReadOnlyList<Request> Requests => _requests.ToArray();
+
+        public int RequestCount => _requests.Count;
+
+        /// <summary>Serves <paramref name="data"/> at /<paramref name="name"/></summary>
+        public void Add(string name, byte[] data)
+        {
+            _files[name] = new Resource
+            {
+                Data = data,
+                ETag = "\"" + Guid.NewGuid().ToString("N") + "\"",
+                Modified = DateTime.UtcNow
+            };
+        }
+
+        public string GetETag(string name)
+        {
+            return _files[name].ETag;
+        }
+
+        /// <summary>Answers the next <paramref name="count"/> requests with <paramref name="status"/></summary>
+        public void FailNext(int count, HttpStatusCode status = HttpStatusCode.ServiceUnavailable)
+        {
+            _failStatus = (int)status;
+            Volatile.Write(ref _failNext, count);
+        }
+
+        /// <summary>Lets the next <paramref name="count"/> requests wait <paramref name="time"/> before they are answered</summary>
+        public void StallNext(int count, TimeSpan time)
+        {
+            _stallTime = time;
+            Volatile.Write(ref _stallNext, count);
+        }
+
+        static bool TryTake(ref int counter)
+        {
+            int n;
+            do
+            {
+                n = Volatile.Read(ref counter);
+
+                if (n <= 0)
+                    return false;
+            }
+            while (Interlocked.CompareExchange(ref counter, n - 1, n) != n);
+
+            return true;
+        }
+
+        async Task Listen()
+        {
+            while (_listener.IsListening)
+            {
+                HttpListenerContext ctx;
+                try
+                {
+                    ctx = await _listener.GetContextAsync().ConfigureAwait(false);
+                }
+                catch (HttpListenerException)
+                {
+                    return;
+                }
+                catch (ObjectDisposedException)
+                {
+                    return;
+                }
+
+                _ = Task.Run(() => Serve(ctx));
+            }
+        }
+
+        async Task Serve(HttpListenerContext ctx)
+        {
+            HttpListenerRequest rq = ctx.Request;
+            HttpListenerResponse rp = ctx.Response;
+            var r = new Request
+            {
+                Path = rq.Url.AbsolutePath,
+                Range = rq.Headers["Range"],
+                IfRange = rq.Headers["If-Range"],
+                UserAgent = rq.UserAgent,
+                Connection = rq.RemoteEndPoint?.ToString()
+            };
+            _requests.Enqueue(r);
+
+            try
+            {
+                if (Delay > TimeSpan.Zero)
+                    await Task.Delay(Delay).ConfigureAwait(false);
+
+                if (TryTake(ref _stallNext))
+                    await Task.Delay(_stallTime).ConfigureAwait(false);
+
+                if (TryTake(ref _failNext))
+                {
+                    rp.StatusCode = r.Status = _failStatus;
+                    return;
+                }
+
+                if (!_files.TryGetValue(r.Path.TrimStart('/'), out var file))
+                {
+                    rp.StatusCode = r.Status = 404;
+                    return;
+                }
+
+                long length = file.Data.Length;
+                long from = 0;
+                long to = length - 1;
+                bool partial = false;
+
+                rp.AddHeader("ETag", file.ETag);
+                rp.AddHeader("Last-Modified", file.Modified.ToString("R", CultureInfo.InvariantCulture));
+                rp.AddHeader("Accept-Ranges", "bytes");
+
+                // Ranges of a changed resource (If-Range mismatch) are answered with the whole resource
+                if (r.Range != null && (r.IfRange == null || r.IfRange == file.ETag))
+                {
+                    if (!TryParseRange(r.Range, length, out from, out to))
+                    {
+                        rp.AddHeader("Content-Range", "bytes */" + length.ToString(CultureInfo.InvariantCulture));
+                        rp.StatusCode = r.Status = 416;
+                        return;
+                    }
+                    partial = true;
+                }
+
+                rp.StatusCode = r.Status = partial ? 206 : 200;
+                if (partial)
+                    rp.AddHeader("Content-Range", string.Format(CultureInfo.InvariantCulture, "bytes {0}-{1}/{2}", from, to, length));
+
+                rp.ContentLength64 = to - from + 1;
+                await rp.OutputStream.WriteAsync(file.Data, (int)from, (int)(to - from + 1)).ConfigureAwait(false);
+            }
+            catch (HttpListenerException)
+            {
+                // The client gave up
+            }
+            catch (ObjectDisposedException)
+            {
+                // The server was stopped
+            }
+            finally
+            {
+                try
+                {
+                    rp.Close();
+                }
+                catch (HttpListenerException)
+                {
+                }
+                catch (ObjectDisposedException)
+                {
+                }
+            }
+        }
+
+        // Parses "bytes=from-to" and "bytes=from-"
+        static bool TryParseRange(string range, long length, out long from, out long to)
+        {
+            from = 0;
+            to = length - 1;
+
+            if (!range.StartsWith("bytes=", StringComparison.OrdinalIgnoreCase))
+                return false;
+
+            string[] parts = range.Substring(6).Split('-');
+
+            if (parts.Length != 2 || !long.TryParse(parts[0], NumberStyles.None, CultureInfo.InvariantCulture, out from) || from >= length)
+                return false;
+
+            if (parts[1].Length > 0)
+            {
+                if (!long.TryParse(parts[1], NumberStyles.None, CultureInfo.InvariantCulture, out to) || to < from)
+                    return false;
+
+                to = Math.Min(to, length - 1);
+            }
+            return true;
+        }
+
+        public void Dispose()
+        {
+            _listener.Stop();
+            _listener.Close();
+        }
+    }
+}
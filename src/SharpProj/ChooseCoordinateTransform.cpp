@@ -6,6 +6,27 @@ using namespace SharpProj;
 
 using System::Collections::Generic::IEnumerable;
 
+ReadOnlyCollection<GridUsage^>^ ChooseCoordinateTransform::Grids::get()
+{
+	if (!m_allGrids)
+	{
+		List<GridUsage^>^ lst = gcnew List<GridUsage^>();
+		System::Collections::Generic::HashSet<String^>^ seen = gcnew System::Collections::Generic::HashSet<String^>();
+
+		for each (CoordinateTransform ^ op in m_operations)
+		{
+			for each (GridUsage ^ g in op->Grids)
+			{
+				if (seen->Add(g->ShortName))
+					lst->Add(g);
+			}
+		}
+
+		m_allGrids = lst->AsReadOnly();
+	}
+	return m_allGrids;
+}
+
 int ChooseCoordinateTransform::SuggestedOperation(PPoint coordinate)
 {
 	PJ_COORD coord;
@@ -14,12 +35,10 @@ int ChooseCoordinateTransform::SuggestedOperation(PPoint coordinate)
 	return proj_get_suggested_operation(Context, m_list, PJ_FWD, coord);
 }
 
-PPoint ChooseCoordinateTransform::DoTransform(bool forward, PPoint% coordinate)
+// Transforms coord with the most suitable operation, and returns that operation via used. Returns false when none of
+// the operations could transform it
+bool ChooseCoordinateTransform::TransformCoord(PJ_DIRECTION dir, PJ_COORD& coord, [Out] CoordinateTransform^% used)
 {
-	PJ_DIRECTION dir = forward ? PJ_FWD : PJ_INV;
-	PJ_COORD coord;
-	SetCoordinate(coord, coordinate);
-
 	constexpr int N_MAX_RETRY = 2;
 
 	const int nOperations = Count;
@@ -56,7 +75,9 @@ PPoint ChooseCoordinateTransform::DoTransform(bool forward, PPoint% coordinate)
 		else if (res.xyzt.x != HUGE_VAL) 
 		{
 			// Success
-			return c->FromCoordinate(res, forward);
+			coord = res;
+			used = c;
+			return true;
 		}
 
 		Context->OnLogMessage(ProjLogLevel::Debug, "Did not result in valid result. Attempting a retry with another operation.");
@@ -83,10 +104,51 @@ PPoint ChooseCoordinateTransform::DoTransform(bool forward, PPoint% coordinate)
 		if (res.xyzt.x != HUGE_VAL)
 		{
 			// Success
-			return c->FromCoordinate(res, forward);
+			coord = res;
+			used = c;
+			return true;
 		}
 
 	}
 
-	throw gcnew ProjException("No usable transform found");
+	used = nullptr;
+	return false;
+}
+
+PPoint ChooseCoordinateTransform::DoTransform(bool forward, PPoint% coordinate)
+{
+	PJ_COORD coord;
+	SetCoordinate(coord, coordinate);
+	CoordinateTransform^ c;
+
+	if (!TransformCoord(forward ? PJ_FWD : PJ_INV, coord, c))
+		throw gcnew ProjException("No usable transform found");
+
+	return c->FromCoordinate(coord, forward);
+}
+
+void ChooseCoordinateTransform::DoTransformGeneric(bool forward, double* x, int xStride, double* y, int yStride, double* z, int zStride, double* t, int tStride, int count)
+{
+	PJ_DIRECTION dir = forward ? PJ_FWD : PJ_INV;
+	CoordinateTransform^ c;
+
+	// The operation is chosen per point, so this can't be handed to proj_trans_generic() as a whole
+	for (int i = 0; i < count; i++)
+	{
+		PJ_COORD coord;
+		coord.xyzt.x = x[i * xStride];
+		coord.xyzt.y = y[i * yStride];
+		coord.xyzt.z = z ? z[i * zStride] : 0.0;
+		coord.xyzt.t = t ? t[i * tStride] : 0.0;
+
+		if (!TransformCoord(dir, coord, c))
+			coord.xyzt.x = coord.xyzt.y = coord.xyzt.z = coord.xyzt.t = HUGE_VAL;
+
+		x[i * xStride] = coord.xyzt.x;
+		y[i * yStride] = coord.xyzt.y;
+		if (z)
+			z[i * zStride] = coord.xyzt.z;
+		if (t)
+			t[i * tStride] = coord.xyzt.t;
+	}
 }
@@ -17,6 +17,7 @@ namespace SharpProj {
 		PJ_OBJ_LIST* m_list;
 		array<CoordinateTransform^>^ m_operations;
 		CoordinateTransform^ m_last;
+		ReadOnlyCollection<GridUsage^>^ m_allGrids;
 
 	internal:
 		ChooseCoordinateTransform(ProjContext^ ctx, PJ* pj, PJ_OBJ_LIST* list)
@@ -63,6 +64,10 @@ namespace SharpProj {
 
 	protected:
 		virtual PPoint DoTransform(bool forward, PPoint% coordinate) override;
+	private protected:
+		virtual void DoTransformGeneric(bool forward, double* x, int xStride, double* y, int yStride, double* z, int zStride, double* t, int tStride, int count) override;
+	private:
+		bool TransformCoord(PJ_DIRECTION dir, PJ_COORD& coord, [Out] CoordinateTransform^% used);
 	private:
 		virtual System::Collections::IEnumerator^ Obj_GetEnumerator() sealed = System::Collections::IEnumerable::GetEnumerator
 		{
@@ -103,6 +108,14 @@ namespace SharpProj {
 			}
 		}
 
+		/// <summary>
+		/// Gets the grids used by any of the operations
+		/// </summary>
+		property ReadOnlyCollection<GridUsage^>^ Grids
+		{
+			virtual ReadOnlyCollection<GridUsage^>^ get() override;
+		}
+
 		property ProjType Type
 		{
 			virtual ProjType get() override
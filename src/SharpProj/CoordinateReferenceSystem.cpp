@@ -53,7 +53,7 @@ CoordinateReferenceSystem^ CoordinateReferenceSystem::Create(String^ from, ProjC
 	if (!ctx)
 		ctx = gcnew ProjContext();
 
-	std::string fromStr = utf8_string(from);
+	utf8_str fromStr(from);
 	PJ* pj = proj_create(ctx, fromStr.c_str());
 
 	if (!pj)
@@ -99,7 +99,7 @@ CoordinateReferenceSystem^ CoordinateReferenceSystem::CreateFromWellKnownText(St
 	PROJ_STRING_LIST errs = nullptr;
 	const char* options[32] = {};
 
-	std::string fromStr = utf8_string(from);
+	utf8_str fromStr(from);
 	PJ* pj = proj_create_from_wkt(ctx, fromStr.c_str(), options, &wrs, &errs);
 
 	warnings = FromStringList(wrs);
@@ -149,7 +149,7 @@ CoordinateReferenceSystem^ CoordinateReferenceSystem::Create(array<String^>^ fro
 	char** lst = new char* [from->Length + 1];
 	for (int i = 0; i < from->Length; i++)
 	{
-		std::string fromStr = utf8_string(from[i]);
+		utf8_str fromStr(from[i]);
 		lst[i] = _strdup(fromStr.c_str());
 	}
 	lst[from->Length] = 0;
@@ -11,12 +11,12 @@ void SharpProj::Proj::Axis::Ensure()
     if (!m_name && proj_cs_get_axis_info(m_cs->Context, m_cs, m_idx,
         &name, &abbrev, &direction, &unit_conv_factor, &unit_name, &unit_auth_name, &unit_code))
     {
-        m_name = Utf8_PtrToString(name);
-        m_abbrev = Utf8_PtrToString(abbrev);
-        m_direction = Utf8_PtrToString(direction);
+        m_name = Utf8_PtrToInternedString(name);
+        m_abbrev = Utf8_PtrToInternedString(abbrev);
+        m_direction = Utf8_PtrToInternedString(direction);
         m_unit_conv_factor = unit_conv_factor;
-        m_unit_name = Utf8_PtrToString(unit_name);
-        m_unit_auth_name = Utf8_PtrToString(unit_auth_name);
-        m_unit_code = Utf8_PtrToString(unit_code);
+        m_unit_name = Utf8_PtrToInternedString(unit_name);
+        m_unit_auth_name = Utf8_PtrToInternedString(unit_auth_name);
+        m_unit_code = Utf8_PtrToInternedString(unit_code);
     }
 }
\ No newline at end of file
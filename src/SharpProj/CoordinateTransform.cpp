@@ -1,5 +1,8 @@
 #include "pch.h"
 #include <geodesic.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 #include "ProjContext.h"
 #include "CoordinateTransform.h"
@@ -27,6 +30,11 @@ SharpProj::CoordinateTransform::~CoordinateTransform()
 		delete m_pgeod;
 		m_pgeod = nullptr;
 	}
+	if (m_scaleField)
+	{
+		delete m_scaleField;
+		m_scaleField = nullptr;
+	}
 }
 
 ProjObject^ SharpProj::CoordinateTransform::DoClone(ProjContext^ ctx)
@@ -35,12 +43,17 @@ ProjObject^ SharpProj::CoordinateTransform::DoClone(ProjContext^ ctx)
 
 	t->m_methodName = m_methodName;
 	t->m_distanceFlags = m_distanceFlags;
+	t->m_equalAreaFactor = m_equalAreaFactor;
 
 	if (m_pgeod && !t->m_pgeod)
 	{
 		t->m_pgeod = new struct geod_geodesic;
 		*t->m_pgeod = *m_pgeod;
 	}
+
+
+	if (m_scaleField && !t->m_scaleField)
+		t->m_scaleField = new distance_scale_field(*m_scaleField);
 	return t;
 }
 
@@ -66,9 +79,7 @@ CoordinateTransform^ CoordinateTransform::Create(CoordinateReferenceSystem^ sour
 	if (!options)
 		options = gcnew CoordinateTransformOptions();
 
-	std::string s_auth;
-	if (!String::IsNullOrEmpty(options->Authority))
-		s_auth = utf8_string(options->Authority);
+	utf8_str s_auth(options->Authority);
 
 	auto operation_ctx = proj_create_operation_factory_context(ctx, s_auth.size() ? s_auth.c_str() : nullptr);
 	if (!operation_ctx) {
@@ -184,6 +195,69 @@ PPoint CoordinateTransform::DoTransform(bool forward, PPoint% coordinate)
 	return FromCoordinate(coord, forward);
 }
 
+static void check_ordinates(array<double>^ ordinates, int offset, int stride, int count, String^ name)
+{
+	if (!ordinates)
+		return;
+	else if (offset < 0 || stride < 1 || (count > 0 && offset + (long long)(count - 1) * stride >= ordinates->Length))
+		throw gcnew ArgumentOutOfRangeException(name);
+}
+
+void CoordinateTransform::DoApplyGeneric(bool forward, array<double>^ x, int xOffset, int xStride, array<double>^ y, int yOffset, int yStride,
+	array<double>^ z, int zOffset, int zStride, array<double>^ t, int tOffset, int tStride, int count)
+{
+	if (!x)
+		throw gcnew ArgumentNullException("x");
+	else if (!y)
+		throw gcnew ArgumentNullException("y");
+	else if (count < 0)
+		throw gcnew ArgumentOutOfRangeException("count");
+
+	check_ordinates(x, xOffset, xStride, count, "x");
+	check_ordinates(y, yOffset, yStride, count, "y");
+	check_ordinates(z, zOffset, zStride, count, "z");
+	check_ordinates(t, tOffset, tStride, count, "t");
+
+	if (!count)
+		return;
+
+	pin_ptr<double> px = &x[xOffset];
+	pin_ptr<double> py = &y[yOffset];
+	pin_ptr<double> pz = nullptr;
+	pin_ptr<double> pt = nullptr;
+
+	if (z)
+		pz = &z[zOffset];
+	if (t)
+		pt = &t[tOffset];
+
+	DoTransformGeneric(forward, px, xStride, py, yStride, pz, zStride, pt, tStride, count);
+}
+
+void CoordinateTransform::DoTransformGeneric(bool forward, double* x, int xStride, double* y, int yStride, double* z, int zStride, double* t, int tStride, int count)
+{
+	Context->ClearError(this);
+
+	// Without t proj_trans_generic() would use HUGE_VAL as epoch, unlike Apply() (and the ChooseCoordinateTransform loop) which
+	// use 0. Broadcast an explicit 0 instead, so time dependent operations give the same results on both paths
+	double zero = 0.0;
+
+	if (!t)
+	{
+		t = &zero;
+		tStride = 0;
+	}
+
+	proj_trans_generic(this, forward ? PJ_FWD : PJ_INV,
+		x, xStride * sizeof(double), count,
+		y, yStride * sizeof(double), count,
+		z, zStride * sizeof(double), z ? count : 0,
+		t, tStride * sizeof(double), (t == &zero) ? 1 : count);
+
+	if (proj_errno(this) == -62 /*PJD_ERR_NETWORK_ERROR*/)
+		throw Context->ConstructException();
+}
+
 PPoint CoordinateTransform::FromCoordinate(const PJ_COORD& coord, bool forward)
 {
 	int axis = 4;
@@ -246,18 +320,139 @@ void SharpProj::Proj::CoordinateTransformParameter::Ensure()
 			&unit_conv_factor, &unit_name, &unit_auth_name,
 			&unit_code, &unit_category))
 		{
-			m_name = Utf8_PtrToString(name);
-			m_auth_name = Utf8_PtrToString(auth_name);
-			m_code = Utf8_PtrToString(code);
+			m_name = Utf8_PtrToInternedString(name);
+			m_auth_name = Utf8_PtrToInternedString(auth_name);
+			m_code = Utf8_PtrToInternedString(code);
 			m_value = value;
 			m_value_string = Utf8_PtrToString(value_string);
 			m_unit_conv_factor = unit_conv_factor;
-			m_unit_name = Utf8_PtrToString(unit_name);
-			m_unit_auth_name = Utf8_PtrToString(unit_auth_name);
-			m_unit_code = Utf8_PtrToString(unit_code);
-			m_unit_category = Utf8_PtrToString(unit_category);
+			m_unit_name = Utf8_PtrToInternedString(unit_name);
+			m_unit_auth_name = Utf8_PtrToInternedString(unit_auth_name);
+			m_unit_code = Utf8_PtrToInternedString(unit_code);
+			m_unit_category = Utf8_PtrToInternedString(unit_category);
+		}
+	}
+}
+
+ReadOnlyCollection<GridUsage^>^ CoordinateTransform::Grids::get()
+{
+	if (!m_grids)
+	{
+		int cnt = proj_coordoperation_get_grid_used_count(Context, this);
+		List<GridUsage^>^ lst = gcnew List<GridUsage^>(Math::Max(cnt, 0));
+
+		for (int i = 0; i < cnt; i++)
+		{
+			const char* short_name;
+			const char* full_name;
+			const char* package_name;
+			const char* url;
+			int direct_download;
+			int open_license;
+			int available;
+
+			if (proj_coordoperation_get_grid_used(Context, this, i, &short_name, &full_name, &package_name, &url,
+				&direct_download, &open_license, &available))
+			{
+				lst->Add(gcnew GridUsage(Utf8_PtrToString(short_name), Utf8_PtrToString(full_name), Utf8_PtrToString(package_name),
+					Utf8_PtrToString(url), 0 != direct_download, 0 != open_license, 0 != available));
+			}
 		}
+
+		m_grids = lst->AsReadOnly();
+	}
+	return m_grids;
+}
+
+bool CoordinateTransform::PrefetchGrids(CoordinateArea^ area)
+{
+	bool allAvailable = true;
+	bool downloaded = false;
+	bool network = (0 != proj_context_is_network_enabled(Context));
+
+	for each (GridUsage ^ g in Grids)
+	{
+		if (network && g->DirectDownload && !String::IsNullOrEmpty(g->Url))
+		{
+			utf8_str url(g->Url);
+
+			if (!proj_is_download_needed(Context, url.c_str(), false))
+				continue;
+			else if (proj_download_file(Context, url.c_str(), false, nullptr, nullptr))
+				downloaded = true;
+			else
+				allAvailable = false;
+		}
+		else if (!g->IsAvailable)
+			allAvailable = false;
+	}
+
+	if (downloaded)
+		ProjContext::ClearFileCache(); // The files were cached as not found
+
+	CoordinateReferenceSystem^ src = area ? SourceCRS : nullptr;
+	CoordinateTransform^ dt = src ? src->DistanceTransform : nullptr;
+
+	if (!dt || !dt->TargetCRS
+		|| (dt->TargetCRS->Type != ProjType::Geographic2DCrs && dt->TargetCRS->Type != ProjType::Geographic3DCrs))
+	{
+		return allAvailable;
+	}
+
+	// Transform a raster of points over the area, which opens the grids and loads the blocks covering it. This goes through
+	// DoTransformGeneric(), so a ChooseCoordinateTransform warms the operations it would choose for these points
+	CoordinateTransform^ toSource = dt->Clone(Context);
+	try
+	{
+		const int steps = 16;
+		double west = area->WestLongitude;
+		double east = area->EastLongitude;
+		array<double>^ xs = gcnew array<double>((steps + 1) * (steps + 1));
+		array<double>^ ys = gcnew array<double>(xs->Length);
+		int n = 0;
+
+		if (east < west)
+			east += 360; // Crosses the antimeridian
+
+		for (int i = 0; i <= steps; i++)
+		{
+			for (int j = 0; j <= steps; j++)
+			{
+				PPoint lonLat(west + (east - west) * i / steps, area->SouthLatitude + (area->NorthLatitude - area->SouthLatitude) * j / steps);
+				PJ_COORD coord;
+				SetCoordinate(coord, lonLat);
+
+				coord = proj_trans(toSource, PJ_INV, coord);
+
+				if (!double::IsNaN(coord.v[0]) && !double::IsInfinity(coord.v[0]))
+				{
+					xs[n] = coord.v[0];
+					ys[n] = coord.v[1];
+					n++;
+				}
+			}
+		}
+		proj_errno_reset(toSource);
+
+		if (n)
+		{
+			pin_ptr<double> px = &xs[0];
+			pin_ptr<double> py = &ys[0];
+
+			DoTransformGeneric(true, px, 1, py, 1, nullptr, 0, nullptr, 0, n);
+		}
+	}
+	catch (ProjException^)
+	{
+		allAvailable = false; // Grid data couldn't be fetched
 	}
+	finally
+	{
+		proj_errno_reset(this);
+		delete toSource;
+	}
+
+	return allAvailable;
 }
 
 enum DistanceFlags
@@ -266,9 +461,111 @@ enum DistanceFlags
 	Setup = 1,
 	ApplyTransform = 2,
 	SwapXY = 4,
-	ApplyRad = 8
+	ApplyRad = 8,
+	NoScaleField = 16
 };
 
+namespace SharpProj {
+	// Meters per CRS unit sampled over the usage area of a conformal projection
+	struct distance_scale_field
+	{
+		static const int steps = 64;
+
+		double minX, minY;
+		double stepX, stepY;
+		std::vector<double> scale; // (steps + 1) * (steps + 1), row major on y
+
+		bool inside(double x, double y) const
+		{
+			double fx = (x - minX) / stepX;
+			double fy = (y - minY) / stepY;
+
+			return (fx >= 0 && fx <= steps && fy >= 0 && fy <= steps);
+		}
+
+		// Returns the distance in meters, or NaN when the segment is not handled by the field
+		double distance(double x1, double y1, double x2, double y2, double maxMeters) const
+		{
+			if (!inside(x1, y1) || !inside(x2, y2))
+				return std::nan("");
+
+			double fx = ((x1 + x2) / 2 - minX) / stepX;
+			double fy = ((y1 + y2) / 2 - minY) / stepY;
+			int ix = std::min((int)fx, steps - 1);
+			int iy = std::min((int)fy, steps - 1);
+			fx -= ix;
+			fy -= iy;
+
+			const double* row = &scale[iy * (steps + 1) + ix];
+			double s = (1 - fy) * ((1 - fx) * row[0] + fx * row[1])
+				+ fy * ((1 - fx) * row[steps + 1] + fx * row[steps + 2]);
+
+			double d = hypot(x2 - x1, y2 - y1) * s;
+
+			return (d <= maxMeters) ? d : std::nan("");
+		}
+	};
+}
+
+namespace {
+	// Conversion methods that preserve area on the ellipsoid
+	const char* const equal_area_methods[] =
+	{
+		"Lambert Azimuthal Equal Area",
+		"Albers Equal Area",
+		"Lambert Cylindrical Equal Area",
+		"Equal Earth",
+		"Sinusoidal",
+		"Bonne",
+	};
+
+	// Conversion methods that only preserve area when applied on a sphere
+	const char* const spherical_equal_area_methods[] =
+	{
+		"Lambert Azimuthal Equal Area (Spherical)",
+		"Lambert Cylindrical Equal Area (Spherical)",
+		"Mollweide",
+		"Eckert IV",
+		"Eckert VI",
+		"Goode Homolosine",
+		"Interrupted Goode Homolosine",
+		"Quartic Authalic",
+	};
+
+	bool is_method(String^ name, const char* const* methods, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			if (String::Equals(name, gcnew String(methods[i]), StringComparison::OrdinalIgnoreCase))
+				return true;
+		}
+		return false;
+	}
+
+	// Returns +1 for east/north oriented axis, -1 for mirrored axis and 0 when unknown
+	int axis_orientation(String^ d0, String^ d1)
+	{
+		int v[2][2] = {};
+		String^ dir[2] = { d0, d1 };
+
+		for (int i = 0; i < 2; i++)
+		{
+			if (String::Equals(dir[i], "east", StringComparison::OrdinalIgnoreCase))
+				v[i][0] = 1;
+			else if (String::Equals(dir[i], "west", StringComparison::OrdinalIgnoreCase))
+				v[i][0] = -1;
+			else if (String::Equals(dir[i], "north", StringComparison::OrdinalIgnoreCase))
+				v[i][1] = 1;
+			else if (String::Equals(dir[i], "south", StringComparison::OrdinalIgnoreCase))
+				v[i][1] = -1;
+			else
+				return 0;
+		}
+
+		return v[0][0] * v[1][1] - v[0][1] * v[1][0];
+	}
+}
+
 void CoordinateTransform::SetupDistance()
 {
 	int d = DistanceFlags::Setup;
@@ -296,63 +593,226 @@ void CoordinateTransform::SetupDistance()
 		{
 			m_pgeod = new struct geod_geodesic;
 
-			geod_init(m_pgeod, el->SemiMajorMetre, 1.0 / el->InverseFlattening);
+			// PROJ reports an inverse flattening of 0 for spheres
+			geod_init(m_pgeod, el->SemiMajorMetre, el->InverseFlattening ? 1.0 / el->InverseFlattening : 0.0);
+		}
+	}
+
+	m_equalAreaFactor = double::NaN;
+
+	CoordinateReferenceSystem^ src = SourceCRS;
+
+	if (m_pgeod && src && src->Type == ProjType::ProjectedCrs)
+	{
+		auto srcAxis = src->Axis;
+		PJ* pj = proj_crs_get_coordoperation(Context, src);
+
+		if (!pj)
+			Context->ClearError(src);
+		else if (srcAxis && srcAxis->Count >= 2)
+		{
+			CoordinateTransform^ conversion = Context->Create<CoordinateTransform^>(pj);
+			try
+			{
+				String^ method = conversion->MethodName;
+				bool sphere = (m_pgeod->f == 0);
+				int orientation = axis_orientation(srcAxis[0]->Direction, srcAxis[1]->Direction);
+
+				if (method && orientation
+					&& (is_method(method, equal_area_methods, sizeof(equal_area_methods) / sizeof(equal_area_methods[0]))
+						|| (sphere && is_method(method, spherical_equal_area_methods, sizeof(spherical_equal_area_methods) / sizeof(spherical_equal_area_methods[0])))))
+				{
+					m_equalAreaFactor = orientation * srcAxis[0]->UnitConversionFactor * srcAxis[1]->UnitConversionFactor;
+				}
+			}
+			finally
+			{
+				delete conversion;
+			}
+		}
+		else
+			proj_destroy(pj);
+	}
+}
+
+bool CoordinateTransform::GeoLatLon(PPoint p, double& lat, double& lon)
+{
+	EnsureDistance();
+
+	if (m_distanceFlags & DistanceFlags::ApplyTransform)
+	{
+		try
+		{
+			p = DoTransform(true, p);
+		}
+		catch (ProjException^)
+		{
+			return false;
 		}
 	}
+
+	bool swapXY = (m_distanceFlags & DistanceFlags::SwapXY);
+
+	lat = swapXY ? p.X : p.Y;
+	lon = swapXY ? p.Y : p.X;
+
+	if (!(m_distanceFlags & DistanceFlags::ApplyRad))
+	{
+		lat = ToDeg(lat);
+		lon = ToDeg(lon);
+	}
+
+	return !(double::IsNaN(lat) || double::IsNaN(lon) || double::IsInfinity(lat) || double::IsInfinity(lon));
 }
 
 double CoordinateTransform::GeoDistance(PPoint p1, PPoint p2)
 {
-	return GeoDistance(gcnew array<PPoint>{p1, p2});
+	return GeoDistance(gcnew array<PPoint>{p1, p2}, 0);
+}
+
+double CoordinateTransform::GeoDistance(PPoint p1, PPoint p2, double planarDistanceThreshold)
+{
+	return GeoDistance(gcnew array<PPoint>{p1, p2}, planarDistanceThreshold);
+}
+
+void CoordinateTransform::DistanceLatLon(PPoint p, double* ll)
+{
+	if (m_distanceFlags & DistanceFlags::ApplyTransform)
+		p = Apply(p);
+
+	bool swapXY = (m_distanceFlags & DistanceFlags::SwapXY);
+
+	ll[0] = swapXY ? p.X : p.Y;
+	ll[1] = swapXY ? p.Y : p.X;
+
+	if (!(m_distanceFlags & DistanceFlags::ApplyRad))
+	{
+		ll[0] = ToDeg(ll[0]);
+		ll[1] = ToDeg(ll[1]);
+	}
+}
+
+bool CoordinateTransform::EnsureScaleField()
+{
+	if (m_scaleField)
+		return true;
+	else if (m_distanceFlags & DistanceFlags::NoScaleField)
+		return false;
+
+	m_distanceFlags |= DistanceFlags::NoScaleField; // Until we know better
+
+	CoordinateReferenceSystem^ src = SourceCRS;
+
+	if (!src || src->Type != ProjType::ProjectedCrs)
+		return false;
+
+	const int steps = distance_scale_field::steps;
+	distance_scale_field field;
+	double unit;
+
+	try
+	{
+		auto ua = src->UsageArea;
+		auto axis = src->Axis;
+
+		if (!ua || !axis || axis->Count < 2)
+			return false;
+
+		unit = axis[0]->UnitConversionFactor;
+		field.minX = ua->MinX;
+		field.minY = ua->MinY;
+		field.stepX = (ua->MaxX - ua->MinX) / steps;
+		field.stepY = (ua->MaxY - ua->MinY) / steps;
+	}
+	catch (ProjException^)
+	{
+		return false;
+	}
+
+	if (!(unit > 0) || !(field.stepX > 0) || !(field.stepY > 0) || !std::isfinite(field.stepX) || !std::isfinite(field.stepY))
+		return false;
+
+	field.scale.reserve((steps + 1) * (steps + 1));
+
+	for (int iy = 0; iy <= steps; iy++)
+	{
+		for (int ix = 0; ix <= steps; ix++)
+		{
+			auto f = GeoFactors(PPoint(field.minX + ix * field.stepX, field.minY + iy * field.stepY));
+
+			// Only conformal projections have a single scale factor for all directions. Allow for numerical noise
+			if (!f || !(Math::Abs(f->AngularDistortion) < 1e-6) || !(f->TissotSemiminor > 0))
+				return false;
+
+			field.scale.push_back(2 * unit / (f->TissotSemimajor + f->TissotSemiminor));
+		}
+	}
+
+	m_scaleField = new distance_scale_field(field);
+	m_distanceFlags &= ~DistanceFlags::NoScaleField;
+	return true;
 }
 
 double CoordinateTransform::GeoDistance(System::Collections::Generic::IEnumerable<PPoint>^ points)
+{
+	return GeoDistance(points, 0);
+}
+
+double CoordinateTransform::GeoDistance(System::Collections::Generic::IEnumerable<PPoint>^ points, double planarDistanceThreshold)
 {
 	if (!points)
 		throw gcnew ArgumentNullException("points");
+	else if (double::IsNaN(planarDistanceThreshold) || planarDistanceThreshold < 0)
+		throw gcnew ArgumentOutOfRangeException("planarDistanceThreshold");
 
 	EnsureDistance();
 
 	if (!m_pgeod)
 		return double::PositiveInfinity; // Like distance methods
 
-	bool applyTransform = (m_distanceFlags & DistanceFlags::ApplyTransform);
-	bool swapXY = (m_distanceFlags & DistanceFlags::SwapXY);
-	bool applyToRad = (m_distanceFlags & DistanceFlags::ApplyRad);
+	bool planar = (planarDistanceThreshold > 0) && EnsureScaleField();
 
 	double ll1[2] = {};
 	double ll2[2] = {};
+	bool haveLL1 = false;
 	bool first = true;
+	PPoint prev;
 
 	double size = 0;
 
 	for each (PPoint p in points)
 	{
-		if (applyTransform)
-			p = Apply(p);
-
-		ll2[0] = swapXY ? p.X : p.Y;
-		ll2[1] = swapXY ? p.Y : p.X;
-
-		if (!applyToRad)
-		{
-			ll2[0] = ToDeg(ll2[0]);
-			ll2[1] = ToDeg(ll2[1]);
-		}
-
 		if (first)
 			first = false;
 		else
 		{
-			double s12, azi1, azi2;
-			/* Note: the geodesic code takes arguments in degrees */
+			double d = planar ? m_scaleField->distance(prev.X, prev.Y, p.X, p.Y, planarDistanceThreshold) : double::NaN;
 
-			geod_inverse(m_pgeod, ll1[0], ll1[1], ll2[0], ll2[1], &s12, &azi1, &azi2);
+			if (!double::IsNaN(d))
+			{
+				size += d;
+				haveLL1 = false;
+			}
+			else
+			{
+				if (!haveLL1)
+					DistanceLatLon(prev, ll1);
+
+				DistanceLatLon(p, ll2);
+
+				double s12, azi1, azi2;
+				/* Note: the geodesic code takes arguments in degrees */
+
+				geod_inverse(m_pgeod, ll1[0], ll1[1], ll2[0], ll2[1], &s12, &azi1, &azi2);
+
+				size += s12;
 
-			size += s12;
+				memcpy(&ll1, &ll2, sizeof(ll1));
+				haveLL1 = true;
+			}
 		}
 
-		memcpy(&ll1, &ll2, sizeof(ll1));
+		prev = p;
 	}
 
 	return size;
@@ -459,8 +919,58 @@ double CoordinateTransform::GeoArea(System::Collections::Generic::IEnumerable<PP
 
 	EnsureDistance();
 
+	if (!double::IsNaN(m_equalAreaFactor))
+		return PlanarArea(points);
+
+	double perimeter;
+
+	return GeoArea(points, perimeter);
+}
+
+double CoordinateTransform::PlanarArea(System::Collections::Generic::IEnumerable<PPoint>^ points)
+{
+	// Shoelace formula, relative to the first point to keep precision on large coordinates. This is a plain scalar loop (not
+	// vectorized), as the points arrive one at a time from the enumeration
+	double x0 = 0, y0 = 0;
+	double px = 0, py = 0;
+	double sum = 0;
+	bool first = true;
+
+	for each (PPoint p in points)
+	{
+		if (first)
+		{
+			x0 = p.X;
+			y0 = p.Y;
+			first = false;
+		}
+		else
+		{
+			double x = p.X - x0;
+			double y = p.Y - y0;
+
+			sum += px * y - x * py;
+			px = x;
+			py = y;
+		}
+	}
+
+	// Sum is counter clockwise positive, while GeoArea is clockwise positive
+	return -sum / 2 * m_equalAreaFactor;
+}
+
+double CoordinateTransform::GeoArea(System::Collections::Generic::IEnumerable<PPoint>^ points, [Out] double% perimeter)
+{
+	if (!points)
+		throw gcnew ArgumentNullException("points");
+
+	EnsureDistance();
+
 	if (!m_pgeod) // Can be null
+	{
+		perimeter = double::PositiveInfinity;
 		return double::PositiveInfinity; // Like distance methods
+	}
 
 	bool applyTransform = (m_distanceFlags & DistanceFlags::ApplyTransform);
 	bool swapXY = (m_distanceFlags & DistanceFlags::SwapXY);
@@ -483,9 +993,30 @@ double CoordinateTransform::GeoArea(System::Collections::Generic::IEnumerable<PP
 	}
 
 	double poly_area;
-	double perim_area;
-	geod_polygon_compute(m_pgeod, &poly, true /* clockwise = positive */, true /* sign */, &poly_area, &perim_area);
+	double poly_perimeter;
+	geod_polygon_compute(m_pgeod, &poly, true /* clockwise = positive */, true /* sign */, &poly_area, &poly_perimeter);
 
+	perimeter = poly_perimeter;
 	return poly_area;
 }
 
+Proj::CoordinateTransformFactors^ CoordinateTransform::GeoFactors(PPoint p)
+{
+	CoordinateReferenceSystem^ crs = SourceCRS;
+	double lat, lon;
+
+	if (!crs || crs->Type != ProjType::ProjectedCrs || !GeoLatLon(p, lat, lon))
+		return nullptr;
+
+	// proj_factors() on a projected CRS expects longitude, latitude in radians on the base geographic CRS
+	PJ_COORD coord = proj_coord(ToRad(lon), ToRad(lat), 0, 0);
+	PJ_FACTORS f = proj_factors(crs, coord);
+
+	if (proj_errno(crs) || !(f.tissot_semimajor > 0))
+	{
+		Context->ClearError(crs);
+		return nullptr;
+	}
+
+	return gcnew Proj::CoordinateTransformFactors(this, &f);
+}
@@ -7,6 +7,7 @@ extern "C" {
 };
 
 namespace SharpProj {
+	struct distance_scale_field;
 	ref class CoordinateTransform;
 	ref class CoordinateReferenceSystem;
 	ref class CoordinateArea;
@@ -218,19 +219,94 @@ namespace SharpProj {
 				}
 			}
 		};
+
+		/// <summary>
+		/// A grid used by a <see cref="CoordinateTransform"/>
+		/// </summary>
+		[System::Diagnostics::DebuggerDisplayAttribute("{ShortName,nq} (Available={IsAvailable})")]
+		public ref class GridUsage
+		{
+		private:
+			initonly String^ m_shortName;
+			initonly String^ m_fullName;
+			initonly String^ m_packageName;
+			initonly String^ m_url;
+			initonly bool m_directDownload;
+			initonly bool m_openLicense;
+			initonly bool m_available;
+
+		internal:
+			GridUsage(String^ shortName, String^ fullName, String^ packageName, String^ url, bool directDownload, bool openLicense, bool available)
+			{
+				m_shortName = shortName;
+				m_fullName = fullName;
+				m_packageName = packageName;
+				m_url = url;
+				m_directDownload = directDownload;
+				m_openLicense = openLicense;
+				m_available = available;
+			}
+
+		public:
+			/// <summary>The name of the grid, as referenced by the operation</summary>
+			property String^ ShortName
+			{
+				String^ get() { return m_shortName; }
+			}
+
+			/// <summary>The full path to the grid, when found locally</summary>
+			property String^ FullName
+			{
+				String^ get() { return m_fullName; }
+			}
+
+			/// <summary>The package that contains the grid</summary>
+			property String^ PackageName
+			{
+				String^ get() { return m_packageName; }
+			}
+
+			/// <summary>The location the grid (or its package) can be downloaded from</summary>
+			property String^ Url
+			{
+				String^ get() { return m_url; }
+			}
+
+			/// <summary>True when <see cref="Url"/> refers to the grid itself, instead of a package</summary>
+			property bool DirectDownload
+			{
+				bool get() { return m_directDownload; }
+			}
+
+			/// <summary>True when the grid is available under an open license</summary>
+			property bool OpenLicense
+			{
+				bool get() { return m_openLicense; }
+			}
+
+			/// <summary>True when the grid was available (locally, or via the network when enabled) when the list was created</summary>
+			property bool IsAvailable
+			{
+				bool get() { return m_available; }
+			}
+		};
 	}
 
 	using CoordinateTransformParameter = Proj::CoordinateTransformParameter;
+	using GridUsage = Proj::GridUsage;
 
 	public ref class CoordinateTransform : ProjObject
 	{
 	private:
 		String^ m_methodName;
 		ReadOnlyCollection<CoordinateTransformParameter^>^ m_params;
+		ReadOnlyCollection<GridUsage^>^ m_grids;
 		CoordinateReferenceSystem^ m_source;
 		CoordinateReferenceSystem^ m_target;
 		int m_distanceFlags;
 		struct geod_geodesic* m_pgeod;
+		double m_equalAreaFactor;
+		distance_scale_field* m_scaleField;
 	internal:
 		CoordinateTransform(ProjContext^ ctx, PJ* pj)
 			: ProjObject(ctx, pj)
@@ -248,9 +324,38 @@ namespace SharpProj {
 		PPoint ApplyReversed(PPoint coord) { return DoTransform(false, coord); }
 		array<double>^ ApplyReversed(...array<double>^ ordinates) { return DoTransform(false, PPoint(ordinates)).ToArray(); }
 
+		/// <summary>
+		/// Transforms <paramref name="count"/> points in place, reading ordinate i of every axis from <c>array[offset + i * stride]</c>.
+		/// Wraps proj_trans_generic(), so ordinates can be transformed directly in (packed, or per axis) buffers. Pass null for
+		/// <paramref name="z"/> and/or <paramref name="t"/> to use 0 for that axis.
+		/// </summary>
+		/// <remarks>Points that can't be transformed are set to <see cref="Double::PositiveInfinity"/></remarks>
+		void ApplyGeneric(array<double>^ x, int xOffset, int xStride, array<double>^ y, int yOffset, int yStride,
+			array<double>^ z, int zOffset, int zStride, array<double>^ t, int tOffset, int tStride, int count)
+		{
+			DoApplyGeneric(true, x, xOffset, xStride, y, yOffset, yStride, z, zOffset, zStride, t, tOffset, tStride, count);
+		}
+
+		/// <summary>
+		/// Reverse version of <see cref="ApplyGeneric"/>
+		/// </summary>
+		void ApplyGenericReversed(array<double>^ x, int xOffset, int xStride, array<double>^ y, int yOffset, int yStride,
+			array<double>^ z, int zOffset, int zStride, array<double>^ t, int tOffset, int tStride, int count)
+		{
+			DoApplyGeneric(false, x, xOffset, xStride, y, yOffset, yStride, z, zOffset, zStride, t, tOffset, tStride, count);
+		}
+
 	protected:
 		virtual PPoint DoTransform(bool forward, PPoint% coords);
 
+	private:
+		void DoApplyGeneric(bool forward, array<double>^ x, int xOffset, int xStride, array<double>^ y, int yOffset, int yStride,
+			array<double>^ z, int zOffset, int zStride, array<double>^ t, int tOffset, int tStride, int count);
+
+	private protected:
+		// Strides are in doubles. Null axes are read as 0
+		virtual void DoTransformGeneric(bool forward, double* x, int xStride, double* y, int yStride, double* z, int zStride, double* t, int tStride, int count);
+
 	internal:
 		PPoint FromCoordinate(const PJ_COORD& coord, bool forward);
 		
@@ -278,6 +383,25 @@ namespace SharpProj {
 			}
 		}
 
+		/// <summary>
+		/// Gets the grids used by this operation
+		/// </summary>
+		property ReadOnlyCollection<GridUsage^>^ Grids
+		{
+			virtual ReadOnlyCollection<GridUsage^>^ get();
+		}
+
+		/// <summary>
+		/// Downloads the grids used by this operation that are not stored locally yet (when network access is enabled), and
+		/// when <paramref name="area"/> is passed opens the grids and loads their data for that area by transforming sample points.
+		/// This moves the grid I/O out of the first real transformations.
+		/// </summary>
+		/// <returns>true when all grids are available, otherwise false</returns>
+		/// <remarks>For a <see cref="ChooseCoordinateTransform"/> the sample points warm the operations chosen for them. The loaded data
+		/// is kept in the grid cache of <see cref="Context"/>; PROJ offers no way to pin its decoded tiles in memory. Combine with
+		/// <see cref="ProjContext::EnableSharedGridFilesOnNewContexts"/> to keep the grid files mapped for all contexts</remarks>
+		bool PrefetchGrids([Optional] CoordinateArea^ area);
+
 		property Nullable<double> Accuraracy
 		{
 			Nullable<double> virtual get()
@@ -319,7 +443,7 @@ namespace SharpProj {
 
 					if (proj_coordoperation_get_method_info(Context, this, &method_name, &auth_name, &auth_code))
 					{
-						m_methodName = Utf8_PtrToString(method_name);
+						m_methodName = Utf8_PtrToInternedString(method_name);
 					}
 				}
 
@@ -380,6 +504,18 @@ namespace SharpProj {
 
 			SetupDistance();
 		}
+
+		bool GeoLatLon(PPoint p, double& lat, double& lon);
+
+		const struct geod_geodesic* GetGeodesic()
+		{
+			EnsureDistance();
+			return m_pgeod;
+		}
+		double PlanarArea(System::Collections::Generic::IEnumerable<PPoint>^ points);
+		bool EnsureScaleField();
+		void DistanceLatLon(PPoint p, double* ll);
+
 	public:
 		void SetupDistance();
 
@@ -396,6 +532,24 @@ namespace SharpProj {
 
 		double GeoDistance(System::Collections::Generic::IEnumerable<PPoint>^ points);
 
+		/// <summary>
+		/// Like <see cref="GeoDistance(PPoint, PPoint)" />, but segments up to <paramref name="planarDistanceThreshold"/> meters may use the planar
+		/// distance, corrected by the local scale factor, instead of transforming both points and calculating the geodesic. Only applied on conformal
+		/// projections (e.g. UTM, RD New) within the usage area of the CoordinateReferenceSystem; other segments always use the exact calculation.
+		/// </summary>
+		/// <param name="p1"></param>
+		/// <param name="p2"></param>
+		/// <param name="planarDistanceThreshold">Maximum segment length in meters for the planar calculation. 0 disables it</param>
+		/// <returns>Distance in meters or Double.NaN if unable to calculate</returns>
+		/// <remarks>The scale factors are sampled once on a 64x64 grid over the usage area and interpolated bilinearly. For segments of a few
+		/// kilometers in a UTM zone sized area this stays well within a millimeter of the geodesic distance.
+		///
+		/// The threshold is passed per call as the instance returned by CoordinateReferenceSystem.DistanceTransform is shared by all users of that CRS.</remarks>
+		double GeoDistance(PPoint p1, PPoint p2, double planarDistanceThreshold);
+
+		/// <inheritdoc cref="GeoDistance(PPoint, PPoint, double)" />
+		double GeoDistance(System::Collections::Generic::IEnumerable<PPoint>^ points, double planarDistanceThreshold);
+
 		/// <summary>
 		/// When called on an instance obtained from CoordinateRefenceSystem.DistanceTransform calculates the distance in meters
 		/// Between p1 and p2 in meters calculating via the GeodeticCRS below the CoordinateReferenceSystem
@@ -432,8 +586,38 @@ namespace SharpProj {
 		/// <summary>
 		/// When called on an instance obtained from CoordinateRefenceSystem.DistanceTransform calculates the area of the polygon defined by points in square meters
 		/// </summary>
+		/// <remarks>When the CoordinateReferenceSystem is an equal-area projection (see <see cref="EqualAreaFactor"/>) the area is calculated
+		/// directly from the projected coordinates. This treats the edges as straight lines in the projection instead of geodesics, which
+		/// is negligible for edges up to a few kilometers (relative difference below 1e-6 for parcel sized polygons)</remarks>
 		double GeoArea(System::Collections::Generic::IEnumerable<PPoint>^ points);
 
+		/// <summary>
+		/// When called on an instance obtained from CoordinateRefenceSystem.DistanceTransform of an equal-area projected CoordinateReferenceSystem
+		/// (e.g. LAEA, Albers, Equal Earth, Sinusoidal), returns the factor that converts a planar polygon area in CRS units (clockwise positive) into
+		/// square meters on the ellipsoid. Otherwise returns NaN
+		/// </summary>
+		property double EqualAreaFactor
+		{
+			double get()
+			{
+				EnsureDistance();
+				return m_equalAreaFactor;
+			}
+		}
+
+		/// <summary>
+		/// When called on an instance obtained from CoordinateRefenceSystem.DistanceTransform calculates the area of the polygon defined by points in square meters,
+		/// and its perimeter in meters in the same pass
+		/// </summary>
+		double GeoArea(System::Collections::Generic::IEnumerable<PPoint>^ points, [Out] double% perimeter);
+
+		/// <summary>
+		/// When called on an instance obtained from CoordinateRefenceSystem.DistanceTransform of a projected CoordinateReferenceSystem, returns the
+		/// projection factors (scale, distortion) at p, which is specified in that CoordinateReferenceSystem
+		/// </summary>
+		/// <returns>The factors, or null if the CoordinateReferenceSystem is not projected or the factors can't be calculated</returns>
+		Proj::CoordinateTransformFactors^ GeoFactors(PPoint p);
+
 	private protected:
 		virtual ProjObject^ DoClone(ProjContext^ ctx) override;
 
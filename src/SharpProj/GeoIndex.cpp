@@ -0,0 +1,302 @@
+#include "pch.h"
+#include <geodesic.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "ProjContext.h"
+#include "CoordinateTransform.h"
+#include "CoordinateReferenceSystem.h"
+#include "GeoIndex.h"
+
+using namespace SharpProj;
+using System::Collections::Generic::List;
+
+namespace {
+	void geo_to_ecef(const struct geod_geodesic* g, double lat, double lon, double* xyz)
+	{
+		const double deg = 3.14159265358979323846 / 180.0;
+		double e2 = g->f * (2 - g->f);
+		double sinphi = sin(lat * deg);
+		double cosphi = cos(lat * deg);
+		double n = g->a / sqrt(1 - e2 * sinphi * sinphi);
+
+		xyz[0] = n * cosphi * cos(lon * deg);
+		xyz[1] = n * cosphi * sin(lon * deg);
+		xyz[2] = n * (1 - e2) * sinphi;
+	}
+
+	struct geo_index_builder
+	{
+		const double* xyz;
+		int* perm;
+		unsigned char* split;
+
+		void build(int lo, int hi)
+		{
+			if (hi - lo <= 1)
+				return;
+
+			double mn[3] = { HUGE_VAL, HUGE_VAL, HUGE_VAL };
+			double mx[3] = { -HUGE_VAL, -HUGE_VAL, -HUGE_VAL };
+
+			for (int i = lo; i < hi; i++)
+			{
+				const double* v = xyz + 3 * perm[i];
+				for (int a = 0; a < 3; a++)
+				{
+					mn[a] = std::min(mn[a], v[a]);
+					mx[a] = std::max(mx[a], v[a]);
+				}
+			}
+
+			int axis = 0;
+			for (int a = 1; a < 3; a++)
+			{
+				if (mx[a] - mn[a] > mx[axis] - mn[axis])
+					axis = a;
+			}
+
+			int mid = lo + (hi - lo) / 2;
+			const double* v = xyz;
+			std::nth_element(perm + lo, perm + mid, perm + hi,
+				[v, axis](int a, int b) { return v[3 * a + axis] < v[3 * b + axis]; });
+
+			split[mid] = (unsigned char)axis;
+			build(lo, mid);
+			build(mid + 1, hi);
+		}
+	};
+
+	struct geo_index_query
+	{
+		const double* xyz;
+		const double* latLon;
+		const unsigned char* split;
+		const struct geod_geodesic* g;
+		double q[3];
+		double lat, lon;
+		size_t k;
+		double radius;
+		std::vector<std::pair<double, int>> found; // Max-heap on distance
+
+		double bound() const
+		{
+			return (found.size() < k) ? radius : found.front().first;
+		}
+
+		void visit(int lo, int hi)
+		{
+			if (lo >= hi)
+				return;
+
+			int mid = lo + (hi - lo) / 2;
+			const double* p = xyz + 3 * mid;
+			double dx = q[0] - p[0];
+			double dy = q[1] - p[1];
+			double dz = q[2] - p[2];
+
+			// The chord is never longer than the geodesic, so it is a safe lower bound
+			if (sqrt(dx * dx + dy * dy + dz * dz) <= bound())
+			{
+				double s12;
+				geod_inverse(g, lat, lon, latLon[2 * mid], latLon[2 * mid + 1], &s12, nullptr, nullptr);
+
+				if (found.size() < k ? (s12 <= radius) : (s12 < found.front().first))
+				{
+					if (found.size() >= k)
+					{
+						std::pop_heap(found.begin(), found.end());
+						found.pop_back();
+					}
+					found.emplace_back(s12, mid);
+					std::push_heap(found.begin(), found.end());
+				}
+			}
+
+			if (hi - lo <= 1)
+				return;
+
+			double diff = q[split[mid]] - p[split[mid]];
+
+			if (diff < 0)
+			{
+				visit(lo, mid);
+				if (-diff <= bound())
+					visit(mid + 1, hi);
+			}
+			else
+			{
+				visit(mid + 1, hi);
+				if (diff <= bound())
+					visit(lo, mid);
+			}
+		}
+	};
+}
+
+GeoIndex::GeoIndex(CoordinateReferenceSystem^ crs, IEnumerable<PPoint>^ points)
+{
+	if (!crs)
+		throw gcnew ArgumentNullException("crs");
+	else if (!points)
+		throw gcnew ArgumentNullException("points");
+
+	CoordinateTransform^ dt = crs->DistanceTransform;
+
+	if (!dt || !dt->GetGeodesic())
+		throw gcnew ArgumentException("Unable to calculate distances in this CoordinateReferenceSystem", "crs");
+
+	m_ctx = crs->Context->Clone();
+	m_dt = dt->Clone(m_ctx);
+
+	const struct geod_geodesic* g = m_dt->GetGeodesic();
+	std::vector<double> xyz;
+	std::vector<double> latLon;
+	std::vector<int> ids;
+	int n = 0;
+
+	for each (PPoint p in points)
+	{
+		double lat, lon;
+
+		if (m_dt->GeoLatLon(p, lat, lon))
+		{
+			double v[3];
+			geo_to_ecef(g, lat, lon, v);
+
+			xyz.insert(xyz.end(), v, v + 3);
+			latLon.push_back(lat);
+			latLon.push_back(lon);
+			ids.push_back(n);
+		}
+		n++;
+	}
+
+	m_count = (int)ids.size();
+
+	std::vector<int> perm(m_count);
+	std::vector<unsigned char> split(m_count);
+
+	for (int i = 0; i < m_count; i++)
+		perm[i] = i;
+
+	if (m_count)
+	{
+		geo_index_builder b = { xyz.data(), perm.data(), split.data() };
+		b.build(0, m_count);
+	}
+
+	// Store the points in tree order
+	m_xyz = gcnew array<double>(3 * m_count);
+	m_latLon = gcnew array<double>(2 * m_count);
+	m_split = gcnew array<Byte>(m_count);
+	m_ids = gcnew array<int>(m_count);
+
+	for (int i = 0; i < m_count; i++)
+	{
+		int src = perm[i];
+
+		m_xyz[3 * i] = xyz[3 * src];
+		m_xyz[3 * i + 1] = xyz[3 * src + 1];
+		m_xyz[3 * i + 2] = xyz[3 * src + 2];
+		m_latLon[2 * i] = latLon[2 * src];
+		m_latLon[2 * i + 1] = latLon[2 * src + 1];
+		m_split[i] = split[i];
+		m_ids[i] = ids[src];
+	}
+
+	m_transforms = gcnew System::Threading::ThreadLocal<CoordinateTransform^>(
+		gcnew Func<CoordinateTransform^>(this, &GeoIndex::CreateTransform), true);
+}
+
+GeoIndex::~GeoIndex()
+{
+	if (m_transforms)
+	{
+		for each (CoordinateTransform ^ t in m_transforms->Values)
+		{
+			ProjContext^ ctx = t->Context;
+			delete t;
+			delete ctx;
+		}
+		delete m_transforms;
+		m_transforms = nullptr;
+	}
+	if ((Object^)m_dt)
+	{
+		delete m_dt;
+		m_dt = nullptr;
+	}
+	if ((Object^)m_ctx)
+	{
+		delete m_ctx;
+		m_ctx = nullptr;
+	}
+}
+
+CoordinateTransform^ GeoIndex::CreateTransform()
+{
+	System::Threading::Monitor::Enter(m_dt);
+	try
+	{
+		return m_dt->Clone();
+	}
+	finally
+	{
+		System::Threading::Monitor::Exit(m_dt);
+	}
+}
+
+array<GeoIndexMatch>^ GeoIndex::Nearest(PPoint coordinate, int count)
+{
+	if (count < 0)
+		throw gcnew ArgumentOutOfRangeException("count");
+
+	return Query(coordinate, count, double::PositiveInfinity);
+}
+
+array<GeoIndexMatch>^ GeoIndex::WithinDistance(PPoint coordinate, double distance)
+{
+	if (double::IsNaN(distance) || distance < 0)
+		throw gcnew ArgumentOutOfRangeException("distance");
+
+	return Query(coordinate, Int32::MaxValue, distance);
+}
+
+array<GeoIndexMatch>^ GeoIndex::Query(PPoint p, int k, double radius)
+{
+	if (!m_transforms)
+		throw gcnew ObjectDisposedException("GeoIndex");
+
+	double lat, lon;
+
+	if (!m_count || !k || !m_transforms->Value->GeoLatLon(p, lat, lon))
+		return Array::Empty<GeoIndexMatch>();
+
+	pin_ptr<double> pXyz = &m_xyz[0];
+	pin_ptr<double> pLatLon = &m_latLon[0];
+	pin_ptr<Byte> pSplit = &m_split[0];
+
+	geo_index_query q;
+	q.xyz = pXyz;
+	q.latLon = pLatLon;
+	q.split = pSplit;
+	q.g = m_dt->GetGeodesic();
+	q.lat = lat;
+	q.lon = lon;
+	q.k = (size_t)k;
+	q.radius = radius;
+	geo_to_ecef(q.g, lat, lon, q.q);
+
+	q.visit(0, m_count);
+
+	std::sort(q.found.begin(), q.found.end());
+
+	array<GeoIndexMatch>^ result = gcnew array<GeoIndexMatch>((int)q.found.size());
+
+	for (int i = 0; i < result->Length; i++)
+		result[i] = GeoIndexMatch(m_ids[q.found[i].second], q.found[i].first);
+
+	return result;
+}
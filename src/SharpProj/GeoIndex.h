@@ -0,0 +1,88 @@
+#pragma once
+#include "CoordinateTransform.h"
+
+namespace SharpProj {
+	using System::Collections::Generic::IEnumerable;
+	ref class CoordinateReferenceSystem;
+
+	/// <summary>
+	/// A single result of a <see cref="GeoIndex"/> query
+	/// </summary>
+	[System::Diagnostics::DebuggerDisplayAttribute("Index={Index}, Distance={Distance}")]
+	public value class GeoIndexMatch
+	{
+	private:
+		int m_index;
+		double m_distance;
+
+	internal:
+		GeoIndexMatch(int index, double distance)
+		{
+			m_index = index;
+			m_distance = distance;
+		}
+
+	public:
+		/// <summary>The position of the point in the sequence used to build the index</summary>
+		property int Index
+		{
+			int get() { return m_index; }
+		}
+
+		/// <summary>The distance in meters over the ellipsoid</summary>
+		property double Distance
+		{
+			double get() { return m_distance; }
+		}
+	};
+
+	/// <summary>
+	/// Immutable spatial index over a set of points in a <see cref="CoordinateReferenceSystem"/>, answering nearest neighbour
+	/// and radius queries in meters over the ellipsoid.
+	/// </summary>
+	/// <remarks>The points are stored as geocentric (ECEF) coordinates on the ellipsoid in a KD-tree. Candidates are
+	/// pruned by their chord distance, which is never larger than the geodesic distance, and refined with the exact
+	/// geodesic calculation. Queries may be performed from multiple threads at the same time.</remarks>
+	[System::Diagnostics::DebuggerDisplayAttribute("Count = {Count}")]
+	public ref class GeoIndex
+	{
+	private:
+		ProjContext^ m_ctx;
+		CoordinateTransform^ m_dt;
+		System::Threading::ThreadLocal<CoordinateTransform^>^ m_transforms;
+		array<double>^ m_xyz;
+		array<double>^ m_latLon;
+		array<Byte>^ m_split;
+		array<int>^ m_ids;
+		int m_count;
+
+	private:
+		~GeoIndex();
+		CoordinateTransform^ CreateTransform();
+		array<GeoIndexMatch>^ Query(PPoint p, int k, double radius);
+
+	public:
+		/// <summary>
+		/// Creates a new index over <paramref name="points"/>, which are interpreted as coordinates in <paramref name="crs"/>.
+		/// Points that can't be converted to the ellipsoid are not indexed.
+		/// </summary>
+		GeoIndex(CoordinateReferenceSystem^ crs, IEnumerable<PPoint>^ points);
+
+	public:
+		/// <summary>The number of indexed points</summary>
+		property int Count
+		{
+			int get() { return m_count; }
+		}
+
+		/// <summary>
+		/// Gets the (at most) <paramref name="count"/> points nearest to <paramref name="coordinate"/>, ordered by distance
+		/// </summary>
+		array<GeoIndexMatch>^ Nearest(PPoint coordinate, int count);
+
+		/// <summary>
+		/// Gets the points within <paramref name="distance"/> meters from <paramref name="coordinate"/>, ordered by distance
+		/// </summary>
+		array<GeoIndexMatch>^ WithinDistance(PPoint coordinate, double distance);
+	};
+}
@@ -1,39 +1,164 @@
 #include "pch.h"
 
-#include <locale>
-#include <codecvt>
+#include <list>
 #include "ProjContext.h"
 #include "ProjException.h"
+#include "SharedFiles.h"
 
 using namespace SharpProj;
 using namespace System::IO;
 
-std::string utf8_string(String^ v)
+utf8_str::utf8_str(String^ value)
 {
-	std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> conv;
-	pin_ptr<const wchar_t> pPath = PtrToStringChars(v);
-	std::wstring vstr(pPath);
-	std::string sstr(conv.to_bytes(vstr));
-	return sstr;
-}
+	m_p = m_buf;
+	m_len = 0;
+	m_buf[0] = 0;
 
-const char* ProjContext::utf8_string(String^ value)
-{
-	void* chain = m_chain;
-	try
+	if (!value || !value->Length)
+		return;
+
+	pin_ptr<const wchar_t> pChars = PtrToStringChars(value);
+	wchar_t* chars = const_cast<wchar_t*>(static_cast<const wchar_t*>(pChars));
+	int len = value->Length;
+	int cap = sizeof(m_buf);
+
+	// A UTF-16 char never needs more than 3 UTF-8 bytes, so only count when it might not fit
+	if (len * 3 >= cap)
 	{
-		return utf8_chain(value, chain);
+		int need = System::Text::Encoding::UTF8->GetByteCount(chars, len);
+
+		if (need >= cap)
+		{
+			cap = need + 1;
+			m_p = new char[cap];
+		}
 	}
-	finally
+
+	m_len = System::Text::Encoding::UTF8->GetBytes(chars, len, (unsigned char*)m_p, cap);
+	m_p[m_len] = 0;
+}
+
+namespace {
+	const int intern_slots = 1024; // Power of 2
+	const size_t intern_max_len = 64;
+}
+
+namespace SharpProj {
+	// Immutable, so a slot can be read without locking and replaced by publishing a new entry
+	private ref class Utf8InternEntry sealed
 	{
-		m_chain = chain;
-	}
+	public:
+		initonly array<Byte>^ Key;
+		initonly String^ Value;
+
+		Utf8InternEntry(const char* pTxt, size_t len)
+		{
+			Key = gcnew array<Byte>((int)len);
+			if (len)
+				System::Runtime::InteropServices::Marshal::Copy(IntPtr((void*)pTxt), Key, 0, (int)len);
+			Value = gcnew String(pTxt, 0, (int)len, System::Text::Encoding::UTF8);
+		}
+
+		bool Matches(const char* pTxt, size_t len)
+		{
+			if ((size_t)Key->Length != len)
+				return false;
+			else if (!len)
+				return true;
+
+			pin_ptr<Byte> pKey = &Key[0];
+			return !memcmp(pKey, pTxt, len);
+		}
+	};
+
+	private ref class Utf8InternTable abstract sealed
+	{
+	public:
+		static initonly array<Utf8InternEntry^>^ Entries = gcnew array<Utf8InternEntry^>(intern_slots);
+	};
+}
+
+String^ Utf8_PtrToInternedString(const char* pTxt)
+{
+	if (!pTxt)
+		return nullptr;
+
+	size_t len = strlen(pTxt);
+
+	if (len > intern_max_len)
+		return gcnew String(pTxt, 0, (int)len, System::Text::Encoding::UTF8);
+
+	unsigned int h = 2166136261u; // FNV-1a
+	for (size_t i = 0; i < len; i++)
+		h = (h ^ (unsigned char)pTxt[i]) * 16777619u;
+
+	int slot = h & (intern_slots - 1);
+	array<Utf8InternEntry^>^ entries = Utf8InternTable::Entries;
+	Utf8InternEntry^ e = System::Threading::Volatile::Read(entries[slot]);
+
+	if (e && e->Matches(pTxt, len))
+		return e->Value;
+
+	// Publish unless another thread replaced the slot meanwhile; either way the string is correct
+	Utf8InternEntry^ created = gcnew Utf8InternEntry(pTxt, len);
+	System::Threading::Interlocked::CompareExchange(entries[slot], created, e);
+	return created->Value;
+}
+
+namespace SharpProj {
+	// Keeps the strings returned to PROJ alive. PROJ copies (or opens) a returned file name before asking again, so only the most
+	// recently returned string must stay valid. A small most-recently-used list keeps repeated lookups of the same files
+	// free of allocations, while bounding the memory of long lived contexts.
+	struct utf8_string_arena
+	{
+		static const size_t max_entries = 32;
+
+		std::list<std::string> strings; // Most recently used first. Nodes (and their buffers) don't move
+		size_t bytes = 0;
+
+		const char* intern(const char* value, size_t len)
+		{
+			for (auto it = strings.begin(); it != strings.end(); it++)
+			{
+				if (it->size() == len && !memcmp(it->c_str(), value, len))
+				{
+					strings.splice(strings.begin(), strings, it);
+					return strings.front().c_str();
+				}
+			}
+
+			strings.emplace_front(value, len);
+			bytes += strings.front().capacity() + 1;
+
+			while (strings.size() > max_entries)
+			{
+				bytes -= strings.back().capacity() + 1;
+				strings.pop_back();
+			}
+
+			return strings.front().c_str();
+		}
+	};
+}
+
+const char* ProjContext::utf8_string(String^ value)
+{
+	if (!m_strings)
+		m_strings = new utf8_string_arena();
+
+	utf8_str v(value);
+	return m_strings->intern(v.c_str(), v.size());
+}
+
+long long ProjContext::RetainedStringBytes::get()
+{
+	return m_strings ? (long long)m_strings->bytes : 0;
 }
 
 const char* ProjContext::utf8_chain(String^ value, void*& chain)
 {
-	std::string v = ::utf8_string(value);
-	int slen = v.length() + 1;
+	utf8_str v(value);
+	int slen = (int)v.size() + 1;
 	void** pp = (void**)malloc(slen + sizeof(void*));
 	pp[0] = chain;
 	chain = pp;
@@ -94,23 +219,49 @@ static void my_log_func(void* user_data, int level, const char* message)
 ProjContext::ProjContext()
 {
 	m_ctx = proj_context_create();
+	m_mapFiles = EnableSharedGridFilesOnNewContexts;
 
 	if (m_ctx)
 	{
-		WeakReference<ProjContext^>^ wr = gcnew WeakReference<ProjContext^>(this);
-		m_ref = new gcroot<WeakReference<ProjContext^>^>(wr);
-
-		proj_context_set_file_finder(m_ctx, my_file_finder, m_ref);
-		proj_log_func(m_ctx, m_ref, my_log_func);
+		SetupCallbacks();
 		proj_log_level(m_ctx, PJ_LOG_ERROR);
-
-		SetupNetworkHandling();
+		SetupDatabase();
 
 		if (EnableNetworkConnectionsOnNewContexts)
 			AllowNetworkConnections = true;
 	}
 }
 
+ProjContext::ProjContext(PJ_CONTEXT* ctx, bool fileApi, bool mapFiles)
+{
+	m_ctx = ctx;
+	m_fileApi = fileApi; // PROJ copied the file api of the original
+	m_mapFiles = mapFiles;
+
+	// The clone copied the callbacks of the original, which would still report to (and outlive) the original instance
+	if (m_ctx)
+		SetupCallbacks();
+}
+
+void ProjContext::SetupCallbacks()
+{
+	WeakReference<ProjContext^>^ wr = gcnew WeakReference<ProjContext^>(this);
+	m_ref = new gcroot<WeakReference<ProjContext^>^>(wr);
+
+	proj_context_set_file_finder(m_ctx, my_file_finder, m_ref);
+	proj_log_func(m_ctx, m_ref, my_log_func);
+
+	// Only replace PROJ's own file access when asked to, or when the registered in-memory grids must be served
+	// Clones keep the choice of their original, whatever EnableSharedGridFilesOnNewContexts is now
+	if (m_mapFiles || m_fileApi || !s_grids->IsEmpty)
+	{
+		proj_context_set_fileapi(m_ctx, shared_proj_file_api(), m_mapFiles ? shared_file_api_map_files : nullptr);
+		m_fileApi = true;
+	}
+
+	SetupNetworkHandling();
+}
+
 inline SharpProj::ProjContext::~ProjContext()
 {
 	if (m_ctx)
@@ -124,14 +275,297 @@ inline SharpProj::ProjContext::~ProjContext()
 		m_ref = nullptr;
 	}
 
-	void* chain = m_chain;
+	if (m_strings)
+	{
+		delete m_strings;
+		m_strings = nullptr;
+	}
+}
+
+// Must be applied before PROJ opens the database. Clones copy the vfs name and database path
+void ProjContext::SetupDatabase()
+{
+	if (s_memoryDatabaseName)
+	{
+		System::Threading::Monitor::Enter(s_memoryLock);
+		try
+		{
+			// Re-check, as the database is released when replaced
+			if (s_memoryDatabaseName)
+			{
+				utf8_str name(s_memoryDatabaseName);
+
+				proj_context_set_sqlite3_vfs_name(m_ctx, shared_sqlite_vfs_name());
+				proj_context_set_database_path(m_ctx, name.c_str(), nullptr, nullptr);
+				return;
+			}
+		}
+		finally
+		{
+			System::Threading::Monitor::Exit(s_memoryLock);
+		}
+	}
+
+	if (s_sharedDatabase)
+		proj_context_set_sqlite3_vfs_name(m_ctx, shared_sqlite_vfs_name());
+}
+
+bool ProjContext::EnableSharedDatabaseOnNewContexts::get()
+{
+	return s_sharedDatabase;
+}
+
+void ProjContext::EnableSharedDatabaseOnNewContexts::set(bool value)
+{
+	if (value && !shared_sqlite_vfs_name())
+		throw gcnew InvalidOperationException("Unable to register the shared database file system");
+
+	s_sharedDatabase = value;
+}
+
+shared_file* ProjContext::CreateMemoryDatabase(long long size, unsigned char*& data, [Out] String^% name)
+{
+	if (size < 100) // The SQLite header
+		throw gcnew ArgumentException("Not a SQLite database", "database");
+	else if (!shared_sqlite_vfs_name())
+		throw gcnew InvalidOperationException("Unable to register the shared database file system");
+
+	name = Utf8_PtrToString(shared_memory_prefix) + "proj-" + System::Threading::Interlocked::Increment(s_memoryDatabaseId) + ".db";
+
+	utf8_str sname(name);
+	shared_file* f = shared_file_create(sname.c_str(), (unsigned long long)size, &data);
+
+	if (!f)
+		throw gcnew OutOfMemoryException();
+
+	return f;
+}
+
+void ProjContext::UseMemoryDatabase(shared_file* file, String^ name)
+{
+	if (memcmp(shared_file_data(file), "SQLite format 3", 16))
+	{
+		shared_file_release(file);
+		throw gcnew ArgumentException("Not a SQLite database", "database");
+	}
+
+	shared_file* old;
+
+	System::Threading::Monitor::Enter(s_memoryLock);
 	try
 	{
-		free_chain(chain);
+		old = s_memoryDatabase;
+		s_memoryDatabase = file;
+		s_memoryDatabaseName = name;
 	}
 	finally
 	{
-		m_chain = chain;
+		System::Threading::Monitor::Exit(s_memoryLock);
+	}
+
+	// Connections that use the old database hold their own reference
+	shared_file_release(old);
+}
+
+void ProjContext::UseInMemoryDatabase(array<Byte>^ database)
+{
+	if (!database)
+		throw gcnew ArgumentNullException("database");
+
+	unsigned char* data;
+	String^ name;
+	shared_file* f = CreateMemoryDatabase(database->LongLength, data, name);
+
+	System::Runtime::InteropServices::Marshal::Copy(database, 0, IntPtr(data), database->Length);
+
+	UseMemoryDatabase(f, name);
+}
+
+void ProjContext::UseInMemoryDatabase(Stream^ database)
+{
+	if (!database)
+		throw gcnew ArgumentNullException("database");
+
+	if (!database->CanSeek)
+	{
+		MemoryStream^ ms = gcnew MemoryStream();
+		database->CopyTo(ms);
+		ms->Position = 0;
+
+		UseInMemoryDatabase(ms);
+		return;
+	}
+
+	long long size = database->Length - database->Position;
+	unsigned char* data;
+	String^ name;
+	shared_file* f = CreateMemoryDatabase(size, data, name);
+
+	try
+	{
+		ReadStream(database, data, size);
+	}
+	catch (Exception^)
+	{
+		shared_file_release(f);
+		throw;
+	}
+
+	UseMemoryDatabase(f, name);
+}
+
+void ProjContext::ReadStream(Stream^ from, unsigned char* to, long long size)
+{
+	array<Byte>^ buffer = gcnew array<Byte>((int)Math::Min(size, 81920LL));
+
+	for (long long done = 0; done < size;)
+	{
+		int n = from->Read(buffer, 0, (int)Math::Min((long long)buffer->Length, size - done));
+
+		if (n <= 0)
+			throw gcnew EndOfStreamException();
+
+		System::Runtime::InteropServices::Marshal::Copy(buffer, 0, IntPtr(to + done), n);
+		done += n;
+	}
+}
+
+void ProjContext::DisableInMemoryDatabase()
+{
+	shared_file* old;
+
+	System::Threading::Monitor::Enter(s_memoryLock);
+	try
+	{
+		old = s_memoryDatabase;
+		s_memoryDatabase = nullptr;
+		s_memoryDatabaseName = nullptr;
+	}
+	finally
+	{
+		System::Threading::Monitor::Exit(s_memoryLock);
+	}
+
+	shared_file_release(old);
+}
+
+static void free_pinned_handle(void* data)
+{
+	System::Runtime::InteropServices::GCHandle::FromIntPtr(IntPtr(data)).Free();
+}
+
+void ProjContext::RegisterGrid(String^ name, const unsigned char* data, long long size, void (*release)(void*), void* release_data)
+{
+	String^ fileName = Utf8_PtrToString(shared_memory_prefix) + "grid/" + name;
+	utf8_str sname(fileName);
+
+	System::Threading::Monitor::Enter(s_memoryLock);
+	try
+	{
+		shared_file_unregister(sname.c_str());
+
+		if (!shared_file_register(sname.c_str(), data, (unsigned long long)size, release, release_data))
+		{
+			if (release)
+				release(release_data);
+
+			throw gcnew InvalidOperationException("Unable to register grid");
+		}
+
+		s_grids[name] = fileName;
+	}
+	finally
+	{
+		System::Threading::Monitor::Exit(s_memoryLock);
+	}
+}
+
+void ProjContext::RegisterGrid(String^ name, array<Byte>^ data)
+{
+	if (String::IsNullOrEmpty(name))
+		throw gcnew ArgumentNullException("name");
+	else if (!data)
+		throw gcnew ArgumentNullException("data");
+	else if (!data->Length)
+		throw gcnew ArgumentException("Grid is empty", "data");
+
+	auto h = System::Runtime::InteropServices::GCHandle::Alloc(data, System::Runtime::InteropServices::GCHandleType::Pinned);
+
+	RegisterGrid(name, (const unsigned char*)h.AddrOfPinnedObject().ToPointer(), data->LongLength,
+		free_pinned_handle, System::Runtime::InteropServices::GCHandle::ToIntPtr(h).ToPointer());
+}
+
+void ProjContext::RegisterGrid(String^ name, IntPtr data, long long length)
+{
+	if (String::IsNullOrEmpty(name))
+		throw gcnew ArgumentNullException("name");
+	else if (data == IntPtr::Zero)
+		throw gcnew ArgumentNullException("data");
+	else if (length <= 0)
+		throw gcnew ArgumentOutOfRangeException("length");
+
+	RegisterGrid(name, (const unsigned char*)data.ToPointer(), length, nullptr, nullptr);
+}
+
+void ProjContext::RegisterGrid(String^ name, Stream^ data)
+{
+	if (String::IsNullOrEmpty(name))
+		throw gcnew ArgumentNullException("name");
+	else if (!data)
+		throw gcnew ArgumentNullException("data");
+
+	if (!data->CanSeek)
+	{
+		MemoryStream^ ms = gcnew MemoryStream();
+		data->CopyTo(ms);
+		ms->Position = 0;
+
+		RegisterGrid(name, ms);
+		return;
+	}
+
+	long long size = data->Length - data->Position;
+
+	if (size <= 0)
+		throw gcnew ArgumentException("Grid is empty", "data");
+
+	unsigned char* p = (unsigned char*)malloc((size_t)size);
+
+	if (!p)
+		throw gcnew OutOfMemoryException();
+
+	try
+	{
+		ReadStream(data, p, size);
+	}
+	catch (Exception^)
+	{
+		free(p);
+		throw;
+	}
+
+	RegisterGrid(name, p, size, free, p);
+}
+
+bool ProjContext::UnregisterGrid(String^ name)
+{
+	if (String::IsNullOrEmpty(name))
+		throw gcnew ArgumentNullException("name");
+
+	System::Threading::Monitor::Enter(s_memoryLock);
+	try
+	{
+		String^ fileName;
+
+		if (!s_grids->TryRemove(name, fileName))
+			return false;
+
+		utf8_str sname(fileName);
+		return shared_file_unregister(sname.c_str());
+	}
+	finally
+	{
+		System::Threading::Monitor::Exit(s_memoryLock);
 	}
 }
 
@@ -140,7 +574,7 @@ String^ ProjContext::GetMetaData(String^ key)
 	if (String::IsNullOrEmpty(key))
 		throw gcnew ArgumentNullException("key");
 
-	std::string skey = utf8_string(key);
+	utf8_str skey(key);
 
 	const char* v = proj_context_get_database_metadata(this, skey.c_str());
 
@@ -200,10 +634,40 @@ String^ ProjContext::EnvCombine(String^ envVar, String^ file)
 }
 
 void ProjContext::OnFindFile(String^ file, [Out] String^% foundFile)
+{
+	if (m_fileApi && s_grids->TryGetValue(file, foundFile))
+		return; // Served from memory by the file api
+
+	if (!m_userDir)
+		m_userDir = Utf8_PtrToString(proj_context_get_user_writable_directory(this, false));
+
+	// Everything the search depends on. Relative names are also probed relative to the current directory
+	String^ key = String::Join("|", file, m_userDir, Environment::GetEnvironmentVariable("PROJ_LIB"),
+		Path::IsPathRooted(file) ? String::Empty : Environment::CurrentDirectory,
+		proj_context_is_network_enabled(this) ? "N" : String::Empty);
+
+	long long now = DateTime::UtcNow.Ticks;
+	FileResolution^ r;
+
+	// Found files are checked again, as they may have been removed since
+	if (s_fileCache->TryGetValue(key, r) && (r->Path ? File::Exists(r->Path) : r->Expires > now))
+	{
+		foundFile = r->Path;
+		return;
+	}
+
+	FindFileUncached(file, foundFile);
+
+	if (s_fileCache->Count >= 4096)
+		s_fileCache->Clear(); // Bound the memory use, when many configurations are used
+
+	s_fileCache[key] = gcnew FileResolution(foundFile, foundFile ? Int64::MaxValue : now + s_fileNotFoundTicks);
+}
+
+void ProjContext::FindFileUncached(String^ file, [Out] String^% foundFile)
 {
 	String^ testFile;
-	const char* pUserDir = proj_context_get_user_writable_directory(this, false);
-	String^ userDir = Utf8_PtrToString(pUserDir);
+	String^ userDir = m_userDir;
 
 	if (File::Exists(testFile = Path::Combine(userDir, file)))
 		foundFile = Path::GetFullPath(testFile);
@@ -215,31 +679,27 @@ void ProjContext::OnFindFile(String^ file, [Out] String^% foundFile)
 		foundFile = Path::GetFullPath(file);
 	else if (File::Exists(file = Path::Combine("..", file)))
 		foundFile = Path::GetFullPath(file);
-	else if (proj_context_is_network_enabled(this))
+	else if (proj_context_is_network_enabled(this) && Path::GetFileName(file)->Equals("proj.db", StringComparison::OrdinalIgnoreCase))
 	{
-		testFile = testFile = Path::Combine(userDir, ("proj" PROJ_VERSION "-") + file);
-		try
-		{
-			DownloadProjDB(testFile);
-		}
-		catch (IOException^)
-		{
-			foundFile = nullptr;
-			return;
-		}
-		catch (System::Net::WebException^)
-		{
-			foundFile = nullptr;
-			return;
-		}
-		catch (InvalidOperationException^)
-		{
-			foundFile = nullptr;
-			return;
-		}
+		testFile = Path::Combine(userDir, "proj" PROJ_VERSION "-proj.db");
 
 		if (File::Exists(testFile))
 			foundFile = Path::GetFullPath(testFile);
+		else
+		{
+			// Don't stall the caller on the download. It starts (or joins) it in the background, and retries when it completed
+			System::Threading::Tasks::Task<String^>^ download = DownloadProjDBAsync(testFile, nullptr, System::Threading::CancellationToken::None);
+
+			if (download->IsCompleted && !download->IsFaulted && !download->IsCanceled && File::Exists(testFile))
+				foundFile = Path::GetFullPath(testFile);
+			else
+			{
+				OnLogMessage(ProjLogLevel::Error, download->IsFaulted
+					? String::Format("Downloading proj.db failed: {0}", download->Exception->GetBaseException()->Message)
+					: "proj.db not found. It is being downloaded in the background (see DownloadProjDBAsync)");
+				foundFile = nullptr;
+			}
+		}
 	}
 	else
 		foundFile = nullptr;
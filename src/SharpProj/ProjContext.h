@@ -6,6 +6,9 @@ namespace SharpProj {
 	namespace Proj {
 		ref class ProjObject;
 	}
+	struct utf8_string_arena;
+	struct shared_file;
+	ref class ProjIOStatistics;
 
 	public enum class ProjLogLevel
 	{
@@ -15,26 +18,172 @@ namespace SharpProj {
 		Trace = PJ_LOG_TRACE
 	};
 
-	public ref class ProjContext
+	private ref class FileResolution sealed
 	{
-	private:
-		PJ_CONTEXT* m_ctx;
-		gcroot<WeakReference<ProjContext^>^>* m_ref;
-		void* m_chain;
+	public:
+		initonly String^ Path;
+		initonly long long Expires; // UTC ticks. Only used for not found results
+
+		FileResolution(String^ path, long long expires)
+		{
+			Path = path;
+			Expires = expires;
+		}
+	};
 
-		ProjContext(PJ_CONTEXT *ctx)
+	// Counters of the network handler, kept per context and process wide
+	private ref class NetworkCounters sealed
+	{
+	public:
+		static initonly NetworkCounters^ Process = gcnew NetworkCounters();
+		literal int LatencyBuckets = 16;
+
+		long long Reads;
+		long long ReadAheadHits;
+		long long CacheHits;
+		long long LocalReads;
+		long long Requests;
+		long long Retries;
+		long long Failures;
+		long long BytesReceived;
+		long long BlockedTicks;
+		initonly array<long long>^ Latency;
+
+		NetworkCounters()
 		{
-			m_ctx = ctx;
+			Latency = gcnew array<long long>(LatencyBuckets);
 		}
+	};
 
+	public ref class ProjContext
+	{
+	private:
+		PJ_CONTEXT* m_ctx;
+		gcroot<WeakReference<ProjContext^>^>* m_ref;
+		utf8_string_arena* m_strings;
+		static bool s_sharedDatabase;
+		static shared_file* s_memoryDatabase;
+		static String^ s_memoryDatabaseName;
+		static int s_memoryDatabaseId;
+		static initonly Object^ s_memoryLock = gcnew Object();
+		static initonly System::Collections::Concurrent::ConcurrentDictionary<String^, FileResolution^>^ s_fileCache
+			= gcnew System::Collections::Concurrent::ConcurrentDictionary<String^, FileResolution^>();
+		static long long s_fileNotFoundTicks = TimeSpan::TicksPerSecond * 30;
+		static initonly System::Collections::Concurrent::ConcurrentDictionary<String^, String^>^ s_grids
+			= gcnew System::Collections::Concurrent::ConcurrentDictionary<String^, String^>(StringComparer::OrdinalIgnoreCase);
+		String^ m_userDir;
+		bool m_fileApi;
+		bool m_mapFiles;
+
+		ProjContext(PJ_CONTEXT *ctx, bool fileApi, bool mapFiles);
+
+		void SetupCallbacks();
 		void SetupNetworkHandling();
+		void SetupDatabase();
+
+		static shared_file* CreateMemoryDatabase(long long size, unsigned char*& data, [Out] String^% name);
+		static void UseMemoryDatabase(shared_file* file, String^ name);
+		static void ReadStream(System::IO::Stream^ from, unsigned char* to, long long size);
+		static void RegisterGrid(String^ name, const unsigned char* data, long long size, void (*release)(void*), void* release_data);
 
 	public:
 		static initonly String^ DefaultEndpointUrl = "https://cdn.proj.org";
 		static property bool EnableNetworkConnectionsOnNewContexts;
 
+		/// <summary>
+		/// When set, new contexts open proj.db read-only via a single process wide memory mapping, instead of each context
+		/// reading (and caching) its own copy of the database pages. Clones inherit the setting of their original.
+		/// </summary>
+		/// <remarks>Connections use the pages in the mapping directly (see <see cref="ProjIOStatistics::DatabasePageFetches"/>). To allow that,
+		/// SharpProj enables SQLite memory mapped I/O (up to 256 MB per database) when it is loaded, which also applies to databases opened
+		/// without this setting. Databases opened for writing (or that can't be mapped) use the normal file access.</remarks>
+		static property bool EnableSharedDatabaseOnNewContexts
+		{
+			bool get();
+			void set(bool value);
+		}
+
+		/// <summary>
+		/// When set, new contexts memory map grid and other resource files once per process and share the mapping, instead of
+		/// each context reading and buffering its own copy. Clones inherit the setting of their original.
+		/// </summary>
+		/// <remarks>A mapped file can't be truncated while in use, but it can be replaced (e.g. by a newer version). Contexts that
+		/// already opened the old version keep reading it, while later opens map the new file. Contexts created without this setting
+		/// (and without registered grids) use PROJ's own file access</remarks>
+		static property bool EnableSharedGridFilesOnNewContexts;
+
+		/// <summary>
+		/// Makes new contexts use an in-memory copy of <paramref name="database"/> (a proj.db SQLite database), shared read-only by
+		/// all of them. Database queries then never touch the file system.
+		/// </summary>
+		/// <remarks>The data is copied once. Existing contexts keep using the database they already opened</remarks>
+		static void UseInMemoryDatabase(array<Byte>^ database);
+		/// <summary>
+		/// Makes new contexts use an in-memory copy of the proj.db SQLite database read from the current position of
+		/// <paramref name="database"/>, shared read-only by all of them. Database queries then never touch the file system.
+		/// </summary>
+		/// <remarks>The data is copied once. Existing contexts keep using the database they already opened</remarks>
+		static void UseInMemoryDatabase(System::IO::Stream^ database);
+		/// <summary>
+		/// Makes new contexts locate proj.db on disk again, after <see cref="UseInMemoryDatabase(array{Byte})"/>
+		/// </summary>
+		static void DisableInMemoryDatabase();
+
+		/// <summary>
+		/// Makes <paramref name="data"/> available to all contexts as the grid file <paramref name="name"/> (e.g. "nl_nsgi_rdtrans2018.tif"),
+		/// replacing an earlier registration. The array is pinned and used as is, so it must not be modified afterwards.
+		/// </summary>
+		/// <remarks>Registered grids are found before grids on disk, and never hit the file system. They are available to contexts
+		/// created after the first registration, and to contexts created with <see cref="EnableSharedGridFilesOnNewContexts"/></remarks>
+		static void RegisterGrid(String^ name, array<Byte>^ data);
+		/// <summary>
+		/// Makes <paramref name="length"/> bytes of unmanaged memory at <paramref name="data"/> available to all contexts as the grid
+		/// file <paramref name="name"/>, without copying. The memory must stay valid until the grid is unregistered and the contexts
+		/// that used it are disposed.
+		/// </summary>
+		static void RegisterGrid(String^ name, IntPtr data, long long length);
+		/// <summary>
+		/// Makes the data from the current position of <paramref name="data"/> available to all contexts as the grid file
+		/// <paramref name="name"/>. The data is copied once
+		/// </summary>
+		static void RegisterGrid(String^ name, System::IO::Stream^ data);
+		/// <summary>
+		/// Removes a grid registered with <see cref="RegisterGrid(String, array{Byte})"/>. Contexts that already opened it keep their access
+		/// </summary>
+		/// <returns>true if the grid was registered, otherwise false</returns>
+		static bool UnregisterGrid(String^ name);
+
+		/// <summary>
+		/// Forgets all file locations resolved by contexts in this process. Call this after adding, moving or removing
+		/// resource files (grids, proj.db, ...) while contexts are in use
+		/// </summary>
+		static void ClearFileCache()
+		{
+			s_fileCache->Clear();
+		}
+
+		/// <summary>
+		/// Gets or sets how long a file that could not be found is remembered as missing. Defaults to 30 seconds.
+		/// Found files are remembered until <see cref="ClearFileCache"/> is called, or until they no longer exist.
+		/// </summary>
+		static property TimeSpan FileNotFoundCacheTime
+		{
+			TimeSpan get()
+			{
+				return TimeSpan(s_fileNotFoundTicks);
+			}
+			void set(TimeSpan value)
+			{
+				if (value < TimeSpan::Zero)
+					throw gcnew ArgumentOutOfRangeException("value");
+
+				s_fileNotFoundTicks = value.Ticks;
+			}
+		}
+
 	internal:
 		String^ m_lastError;
+		NetworkCounters^ m_networkCounters;
 
 		const char* utf8_string(String^ value);
 
@@ -48,9 +197,15 @@ namespace SharpProj {
 
 		ProjContext^ Clone()
 		{
-			return gcnew ProjContext(proj_context_clone(this));
+			return gcnew ProjContext(proj_context_clone(this), m_fileApi, m_mapFiles);
 		}
 
+		/// <summary>
+		/// Gets or sets whether this context may download grids (see <see cref="EndpointUrl"/>), and proj.db when it is missing
+		/// </summary>
+		/// <remarks>A missing proj.db is downloaded in the background (see <see cref="DownloadProjDBAsync"/>). The context doesn't wait
+		/// for that: until the download completed, creating objects from the database fails as if proj.db was not found. Await
+		/// <see cref="DownloadProjDBAsync"/> at startup to avoid these failures</remarks>
 		property bool AllowNetworkConnections
 		{
 			bool get()
@@ -63,19 +218,15 @@ namespace SharpProj {
 			}
 		}
 
+		/// <summary>
+		/// Gets or sets the url grids are read from when <see cref="AllowNetworkConnections"/> is set. Defaults to <see cref="DefaultEndpointUrl"/>
+		/// </summary>
+		/// <remarks>A local directory or file:// url is used as offline mirror of the endpoint. Ranges are then read from memory
+		/// mapped files in that directory, without any HTTP traffic. Getting the property then returns the full path of the directory</remarks>
 		property String^ EndpointUrl
 		{
-			String^ get()
-			{
-				const char* c = proj_context_get_url_endpoint(this);
-				return (c && *c) ? Utf8_PtrToString(c) : nullptr;
-			}
-			void set(String^ value)
-			{
-				std::string url = utf8_string(value);
-
-				proj_context_set_url_endpoint(this, url.c_str());
-			}
+			String^ get();
+			void set(String^ value);
 		}
 
 		void SetGridCache(bool enabled, String^ path, int max_mb, int ttl_seconds)
@@ -83,7 +234,7 @@ namespace SharpProj {
 			proj_grid_cache_set_enable(this, enabled);
 			if (enabled && path)
 			{
-				std::string p = utf8_string(path);
+				utf8_str p(path);
 				proj_grid_cache_set_filename(this, p.c_str());
 			}
 			proj_grid_cache_set_max_size(this, max_mb > 0 ? max_mb : -1);
@@ -95,6 +246,18 @@ namespace SharpProj {
 			proj_grid_cache_clear(this);
 		}
 
+		/// <summary>
+		/// Gets a snapshot of the network reads done for this context: requests, bytes, latencies, cache hits and the time
+		/// transforms were blocked on them. See <see cref="ProjNetwork::GetStatistics"/> for the process wide totals
+		/// </summary>
+		property ProjIOStatistics^ IOStatistics
+		{
+			ProjIOStatistics^ get();
+		}
+
+	private:
+		void FindFileUncached(String^ file, [Out] String^% foundFile);
+
 	protected public:
 		void OnFindFile(String^ file, [Out] String^% foundFile);
 		void OnLogMessage(ProjLogLevel level, String^ message);
@@ -136,6 +299,15 @@ namespace SharpProj {
 
 		event System::Action<ProjLogLevel, String^>^ Log;
 
+		/// <summary>
+		/// Gets the number of bytes currently retained by this context for strings handed to PROJ, such as resolved file names.
+		/// This is bounded, as only the most recently used distinct strings are kept.
+		/// </summary>
+		property long long RetainedStringBytes
+		{
+			long long get();
+		}
+
 		String^ GetMetaData(String^ key);
 
 	public:
@@ -164,6 +336,30 @@ namespace SharpProj {
 		static String^ EnvCombine(String^ envVar, String^ file);
 
 	public:
+		/// <summary>
+		/// Gets the location where <see cref="DownloadProjDBAsync"/> stores proj.db by default, and where contexts look for it
+		/// </summary>
+		static property String^ DefaultProjDBPath
+		{
+			String^ get();
+		}
+
+		/// <summary>
+		/// Downloads proj.db (from <see cref="ProjNetwork::ProjDBPackageUrl"/>) to <paramref name="toPath"/>, or to <see cref="DefaultProjDBPath"/>.
+		/// Call this at startup when proj.db may be missing. A context that allows network connections only starts this download
+		/// in the background when it doesn't find proj.db, without blocking: its database access fails with "proj.db not found"
+		/// until the download completed.
+		/// </summary>
+		/// <remarks>Calls for the same path share a single download, also between processes. Cancelling <paramref name="cancellationToken"/>
+		/// only stops waiting for it. An interrupted download resumes where it stopped when the package didn't change, and the result is
+		/// only moved in place after it passed an integrity check. Completes immediately when the file already exists</remarks>
+		/// <returns>The full path of the database</returns>
+		static System::Threading::Tasks::Task<String^>^ DownloadProjDBAsync([Optional] String^ toPath, [Optional] IProgress<double>^ progress,
+			[Optional] System::Threading::CancellationToken cancellationToken);
+
+		/// <summary>
+		/// Synchronous version of <see cref="DownloadProjDBAsync"/>
+		/// </summary>
 		static void DownloadProjDB(String^ toPath);
 	internal:
 		static operator PJ_CONTEXT* (ProjContext^ me)
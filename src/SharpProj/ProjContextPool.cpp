@@ -0,0 +1,144 @@
+#include "pch.h"
+
+#include "ProjContext.h"
+#include "ProjContextPool.h"
+
+using namespace SharpProj;
+
+ProjContextPool::ProjContextPool(ProjContext^ configuration, int size)
+{
+	if (!configuration)
+		throw gcnew ArgumentNullException("configuration");
+
+	Init(configuration, size);
+}
+
+ProjContextPool::ProjContextPool(int size)
+{
+	ProjContext^ configuration = gcnew ProjContext();
+	try
+	{
+		Init(configuration, size);
+	}
+	finally
+	{
+		delete configuration;
+	}
+}
+
+void ProjContextPool::Init(ProjContext^ configuration, int size)
+{
+	if (size <= 0)
+		throw gcnew ArgumentOutOfRangeException("size");
+
+	m_all = gcnew array<ProjContext^>(size);
+	m_free = gcnew Stack<ProjContext^>(size);
+	m_leased = gcnew HashSet<ProjContext^>();
+	m_available = gcnew System::Threading::SemaphoreSlim(size, size);
+	m_logLevel = configuration->LogLevel;
+	m_allowNetwork = configuration->AllowNetworkConnections;
+
+	for (int i = 0; i < size; i++)
+	{
+		m_all[i] = configuration->Clone();
+		m_free->Push(m_all[i]);
+	}
+}
+
+ProjContextPool::~ProjContextPool()
+{
+	System::Threading::Monitor::Enter(m_free);
+	try
+	{
+		if (m_disposed)
+			return;
+
+		m_disposed = true;
+
+		// Leased contexts are disposed when they are returned
+		while (m_free->Count)
+			delete m_free->Pop();
+	}
+	finally
+	{
+		System::Threading::Monitor::Exit(m_free);
+	}
+}
+
+ProjContext^ ProjContextPool::Take()
+{
+	System::Threading::Monitor::Enter(m_free);
+	try
+	{
+		if (m_disposed)
+		{
+			m_available->Release();
+			throw gcnew ObjectDisposedException("ProjContextPool");
+		}
+
+		ProjContext^ ctx = m_free->Pop();
+		m_leased->Add(ctx);
+		return ctx;
+	}
+	finally
+	{
+		System::Threading::Monitor::Exit(m_free);
+	}
+}
+
+ProjContext^ ProjContextPool::Lease()
+{
+	if (m_disposed)
+		throw gcnew ObjectDisposedException("ProjContextPool");
+
+	m_available->Wait();
+
+	return Take();
+}
+
+bool ProjContextPool::TryLease(TimeSpan timeout, [Out] ProjContext^% context)
+{
+	if (m_disposed)
+		throw gcnew ObjectDisposedException("ProjContextPool");
+
+	if (!m_available->Wait(timeout))
+	{
+		context = nullptr;
+		return false;
+	}
+
+	context = Take();
+	return true;
+}
+
+void ProjContextPool::Return(ProjContext^ context)
+{
+	if (!context)
+		throw gcnew ArgumentNullException("context");
+
+	System::Threading::Monitor::Enter(m_free);
+	try
+	{
+		if (!m_leased->Remove(context))
+			throw gcnew ArgumentException("Context is not leased from this pool", "context");
+
+		if (m_disposed)
+		{
+			delete context;
+			return;
+		}
+
+		// Reset the state the previous user may have left behind
+		context->ClearError();
+		context->LogLevel = m_logLevel;
+		context->AllowNetworkConnections = m_allowNetwork;
+
+		m_free->Push(context);
+	}
+	finally
+	{
+		System::Threading::Monitor::Exit(m_free);
+	}
+
+	m_available->Release();
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "ProjContext.h"
+
+namespace SharpProj {
+	using System::Collections::Generic::HashSet;
+	using System::Collections::Generic::Stack;
+
+	/// <summary>
+	/// Fixed size pool of <see cref="ProjContext"/> instances for server style workloads. Every context is created up front as a
+	/// clone of a configured context, so it shares its network, endpoint, grid cache, database and log level settings. A context
+	/// can only be used by one thread at a time; <see cref="Lease()"/> blocks until one is available, which bounds concurrency
+	/// to the size of the pool.
+	/// </summary>
+	[System::Diagnostics::DebuggerDisplayAttribute("Available = {Available}/{Size}")]
+	public ref class ProjContextPool
+	{
+	private:
+		array<ProjContext^>^ m_all;
+		Stack<ProjContext^>^ m_free;
+		HashSet<ProjContext^>^ m_leased;
+		System::Threading::SemaphoreSlim^ m_available;
+		ProjLogLevel m_logLevel;
+		bool m_allowNetwork;
+		bool m_disposed;
+
+	private:
+		~ProjContextPool();
+		void Init(ProjContext^ configuration, int size);
+		ProjContext^ Take();
+
+	public:
+		/// <summary>
+		/// Creates a pool of <paramref name="size"/> contexts, configured like <paramref name="configuration"/>. The configuration
+		/// context itself is not part of the pool and remains owned by the caller
+		/// </summary>
+		ProjContextPool(ProjContext^ configuration, int size);
+
+		/// <summary>
+		/// Creates a pool of <paramref name="size"/> contexts with the default configuration
+		/// </summary>
+		ProjContextPool(int size);
+
+	public:
+		/// <summary>The number of contexts in the pool</summary>
+		property int Size
+		{
+			int get() { return m_all->Length; }
+		}
+
+		/// <summary>The number of contexts that can be leased without waiting</summary>
+		property int Available
+		{
+			int get() { return m_available->CurrentCount; }
+		}
+
+		/// <summary>
+		/// Leases a context from the pool, waiting until one is available. The context must be passed to <see cref="Return"/>
+		/// when done, and must not be disposed by the caller
+		/// </summary>
+		ProjContext^ Lease();
+
+		/// <summary>
+		/// Tries to lease a context from the pool, waiting at most <paramref name="timeout"/>
+		/// </summary>
+		/// <returns>true if a context was leased, otherwise false</returns>
+		bool TryLease(TimeSpan timeout, [Out] ProjContext^% context);
+
+		/// <summary>
+		/// Returns a context obtained from <see cref="Lease"/> to the pool. The error state and log level are reset
+		/// </summary>
+		void Return(ProjContext^ context);
+	};
+}
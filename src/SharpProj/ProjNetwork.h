@@ -0,0 +1,430 @@
+#pragma once
+
+namespace SharpProj {
+	/// <summary>
+	/// Snapshot of the grid I/O counters of a context (<see cref="ProjContext::IOStatistics"/>) or of the whole process
+	/// (<see cref="ProjNetwork::GetStatistics"/>). Compare two snapshots to measure an interval
+	/// </summary>
+	public ref class ProjIOStatistics sealed
+	{
+	private:
+		long long m_reads;
+		long long m_readAheadHits;
+		long long m_cacheHits;
+		long long m_localReads;
+		long long m_requests;
+		long long m_retries;
+		long long m_failures;
+		long long m_bytesReceived;
+		long long m_blockedTicks;
+		array<long long>^ m_latency;
+		long long m_fileReads;
+		long long m_fileBytes;
+		long long m_fileTicks;
+		long long m_fileMappings;
+		long long m_databaseFetches;
+
+	internal:
+		ProjIOStatistics(NetworkCounters^ counters, long long fileReads, long long fileBytes, long long fileTicks, long long fileMappings, long long databaseFetches);
+
+	public:
+		/// <summary>The number of range reads PROJ did via the network callbacks</summary>
+		property long long Reads
+		{
+			long long get()
+			{
+				return m_reads;
+			}
+		}
+
+		/// <summary>The number of reads served from the read-ahead of an open grid</summary>
+		property long long ReadAheadHits
+		{
+			long long get()
+			{
+				return m_readAheadHits;
+			}
+		}
+
+		/// <summary>The number of reads served from the in-memory chunk cache</summary>
+		property long long CacheHits
+		{
+			long long get()
+			{
+				return m_cacheHits;
+			}
+		}
+
+		/// <summary>The number of reads served from a local mirror (see <see cref="ProjContext::EndpointUrl"/>)</summary>
+		property long long LocalReads
+		{
+			long long get()
+			{
+				return m_localReads;
+			}
+		}
+
+		/// <summary>The number of HTTP requests, including retries</summary>
+		property long long Requests
+		{
+			long long get()
+			{
+				return m_requests;
+			}
+		}
+
+		/// <summary>The number of retried requests</summary>
+		property long long Retries
+		{
+			long long get()
+			{
+				return m_retries;
+			}
+		}
+
+		/// <summary>The number of reads that failed after all retries</summary>
+		property long long Failures
+		{
+			long long get()
+			{
+				return m_failures;
+			}
+		}
+
+		/// <summary>The number of bytes received over HTTP</summary>
+		property long long BytesReceived
+		{
+			long long get()
+			{
+				return m_bytesReceived;
+			}
+		}
+
+		/// <summary>The total time transforms waited for network reads</summary>
+		property TimeSpan BlockedTime
+		{
+			TimeSpan get()
+			{
+				return TimeSpan(m_blockedTicks);
+			}
+		}
+
+		/// <summary>The fraction of the (non local) reads that didn't need a request of their own</summary>
+		property double CacheHitRatio
+		{
+			double get()
+			{
+				long long remote = m_reads - m_localReads;
+				return remote > 0 ? (double)(m_readAheadHits + m_cacheHits) / remote : 0.0;
+			}
+		}
+
+		/// <summary>
+		/// The number of requests per latency bucket. Bucket i counts the requests that took less than
+		/// <see cref="LatencyBucketLimits"/>[i], and at least the limit of the bucket before it
+		/// </summary>
+		property array<long long>^ LatencyHistogram
+		{
+			array<long long>^ get()
+			{
+				return safe_cast<array<long long>^>(m_latency->Clone());
+			}
+		}
+
+		/// <summary>The upper bounds of the buckets of <see cref="LatencyHistogram"/></summary>
+		static property array<TimeSpan>^ LatencyBucketLimits
+		{
+			array<TimeSpan>^ get();
+		}
+
+		/// <summary>The number of reads through the PROJ file API (grids, resource files). Process wide only</summary>
+		property long long FileReads
+		{
+			long long get()
+			{
+				return m_fileReads;
+			}
+		}
+
+		/// <summary>The number of bytes read through the PROJ file API. Process wide only</summary>
+		property long long FileBytesRead
+		{
+			long long get()
+			{
+				return m_fileBytes;
+			}
+		}
+
+		/// <summary>The total time spent in reads through the PROJ file API. Process wide only</summary>
+		property TimeSpan FileReadTime
+		{
+			TimeSpan get()
+			{
+				return TimeSpan(m_fileTicks);
+			}
+		}
+
+		/// <summary>
+		/// The number of files memory mapped for <see cref="ProjContext::EnableSharedGridFilesOnNewContexts"/> and
+		/// <see cref="ProjContext::EnableSharedDatabaseOnNewContexts"/>. A file used by many contexts is mapped once. Process wide only
+		/// </summary>
+		property long long FileMappings
+		{
+			long long get()
+			{
+				return m_fileMappings;
+			}
+		}
+
+		/// <summary>
+		/// The number of database pages used directly from the shared mapping of <see cref="ProjContext::EnableSharedDatabaseOnNewContexts"/>,
+		/// without copying them into the page cache of a connection. Process wide only
+		/// </summary>
+		property long long DatabasePageFetches
+		{
+			long long get()
+			{
+				return m_databaseFetches;
+			}
+		}
+	};
+
+	/// <summary>
+	/// Process wide settings of the network access used by contexts with <see cref="ProjContext::AllowNetworkConnections"/> enabled.
+	/// All contexts share a single pooled HTTP client, so connections (and their TLS sessions) are reused between range reads.
+	/// </summary>
+	public ref class ProjNetwork abstract sealed
+	{
+	private:
+		static int s_maxConnections = 8;
+		static TimeSpan s_timeout = TimeSpan::FromSeconds(30);
+		static int s_maxReadAhead = 1024 * 1024;
+		static long long s_chunkCacheSize = 64 * 1024 * 1024;
+		static int s_maxRetries = 3;
+		static TimeSpan s_retryDelay = TimeSpan::FromMilliseconds(250);
+		static int s_breakerThreshold = 5;
+		static TimeSpan s_breakerDuration = TimeSpan::FromSeconds(30);
+		static String^ s_projDBPackageUrl = "https://www.nuget.org/api/v2/package/SharpProj.Database/" PROJ_VERSION;
+		[System::ThreadStatic]
+		static Random^ t_random;
+		static System::Net::Http::HttpClient^ s_client;
+		static initonly Object^ s_lock = gcnew Object();
+
+	public:
+		/// <summary>
+		/// Gets or sets the maximum number of simultaneous connections to a single server. Defaults to 8
+		/// </summary>
+		static property int MaxConnectionsPerServer
+		{
+			int get()
+			{
+				return s_maxConnections;
+			}
+			void set(int value)
+			{
+				if (value < 1)
+					throw gcnew ArgumentOutOfRangeException("value");
+
+				s_maxConnections = value;
+			}
+		}
+
+		/// <summary>
+		/// Gets or sets the time allowed for a single request, including reading the response. Defaults to 30 seconds
+		/// </summary>
+		/// <remarks>PROJ reads grids synchronously, so the transforming thread is blocked while a request (and the delay before
+		/// a retry) is pending: up to (<see cref="MaxRetries"/> + 1) times this timeout plus the retry delays. The wait itself doesn't
+		/// need other thread pool threads to complete or to time out, but the blocked thread is unavailable. When transforms run on
+		/// thread pool threads (e.g. via Parallel.For), slow or failing servers can therefore starve the pool. Keep this timeout short
+		/// for such workloads, or prefetch the grids first (<see cref="CoordinateTransform::PrefetchGrids"/>)</remarks>
+		static property TimeSpan Timeout
+		{
+			TimeSpan get()
+			{
+				return s_timeout;
+			}
+			void set(TimeSpan value)
+			{
+				if (value <= TimeSpan::Zero && value != System::Threading::Timeout::InfiniteTimeSpan)
+					throw gcnew ArgumentOutOfRangeException("value");
+
+				s_timeout = value;
+			}
+		}
+
+		/// <summary>
+		/// Gets or sets how often a request that failed in a possibly transient way (timeout, connection failure, HTTP 5xx,
+		/// 408 or 429) is retried. Defaults to 3
+		/// </summary>
+		static property int MaxRetries
+		{
+			int get()
+			{
+				return s_maxRetries;
+			}
+			void set(int value)
+			{
+				if (value < 0)
+					throw gcnew ArgumentOutOfRangeException("value");
+
+				s_maxRetries = value;
+			}
+		}
+
+		/// <summary>
+		/// Gets or sets the delay before the first retry. Every next retry doubles the delay (up to 10 seconds), with random
+		/// jitter of up to half the delay. Defaults to 250 milliseconds
+		/// </summary>
+		static property TimeSpan BaseRetryDelay
+		{
+			TimeSpan get()
+			{
+				return s_retryDelay;
+			}
+			void set(TimeSpan value)
+			{
+				if (value < TimeSpan::Zero)
+					throw gcnew ArgumentOutOfRangeException("value");
+
+				s_retryDelay = value;
+			}
+		}
+
+		/// <summary>
+		/// Gets or sets the number of consecutive failed requests (after retries) to a server after which further requests
+		/// fail immediately for <see cref="CircuitBreakerDuration"/>. Set to 0 to disable. Defaults to 5
+		/// </summary>
+		static property int CircuitBreakerThreshold
+		{
+			int get()
+			{
+				return s_breakerThreshold;
+			}
+			void set(int value)
+			{
+				if (value < 0)
+					throw gcnew ArgumentOutOfRangeException("value");
+
+				s_breakerThreshold = value;
+			}
+		}
+
+		/// <summary>
+		/// Gets or sets how long requests to a failing server fail immediately, before a single trial request is made.
+		/// Defaults to 30 seconds
+		/// </summary>
+		static property TimeSpan CircuitBreakerDuration
+		{
+			TimeSpan get()
+			{
+				return s_breakerDuration;
+			}
+			void set(TimeSpan value)
+			{
+				if (value < TimeSpan::Zero)
+					throw gcnew ArgumentOutOfRangeException("value");
+
+				s_breakerDuration = value;
+			}
+		}
+
+		/// <summary>
+		/// Gets or sets the url of the SharpProj.Database package that <see cref="ProjContext::DownloadProjDBAsync"/> extracts proj.db from.
+		/// Defaults to the package matching the wrapped PROJ version on nuget.org
+		/// </summary>
+		static property String^ ProjDBPackageUrl
+		{
+			String^ get()
+			{
+				return s_projDBPackageUrl;
+			}
+			void set(String^ value)
+			{
+				if (!value)
+					throw gcnew ArgumentNullException("value");
+
+				s_projDBPackageUrl = value;
+			}
+		}
+
+		/// <summary>
+		/// Gets or sets the largest range fetched by a single request. Sequential reads of a grid double the fetched range up
+		/// to this size, serving the following reads from memory. Set to 0 to fetch exactly what PROJ asks for. Defaults to 1 MB
+		/// </summary>
+		static property int MaxReadAheadSize
+		{
+			int get()
+			{
+				return s_maxReadAhead;
+			}
+			void set(int value)
+			{
+				if (value < 0)
+					throw gcnew ArgumentOutOfRangeException("value");
+
+				s_maxReadAhead = value;
+			}
+		}
+
+		/// <summary>
+		/// Gets or sets the size in bytes of the in-memory cache of fetched ranges, shared by all contexts. Set to 0 to disable.
+		/// Defaults to 64 MB
+		/// </summary>
+		/// <remarks>Unlike the grid cache of <see cref="ProjContext::SetGridCache"/> this cache doesn't survive the process</remarks>
+		static property long long ChunkCacheSize
+		{
+			long long get()
+			{
+				return s_chunkCacheSize;
+			}
+			void set(long long value)
+			{
+				if (value < 0)
+					throw gcnew ArgumentOutOfRangeException("value");
+
+				s_chunkCacheSize = value;
+			}
+		}
+
+		/// <summary>The number of reads served from the in-memory cache</summary>
+		static property long long ChunkCacheHits
+		{
+			long long get();
+		}
+
+		/// <summary>The number of reads that required a request</summary>
+		static property long long ChunkCacheMisses
+		{
+			long long get();
+		}
+
+		/// <summary>The number of ranges removed from the in-memory cache to stay within <see cref="ChunkCacheSize"/></summary>
+		static property long long ChunkCacheEvictions
+		{
+			long long get();
+		}
+
+		/// <summary>The number of bytes currently held by the in-memory cache</summary>
+		static property long long ChunkCacheBytes
+		{
+			long long get();
+		}
+
+		/// <summary>Removes all ranges from the in-memory cache</summary>
+		static void ClearChunkCache();
+
+		/// <summary>
+		/// Gets a snapshot of the process wide grid I/O counters. The network requests are also traced by the
+		/// "SharpProj-Network" EventSource
+		/// </summary>
+		static ProjIOStatistics^ GetStatistics();
+
+	internal:
+		static TimeSpan RetryDelay(int attempt);
+
+		static property System::Net::Http::HttpClient^ Client
+		{
+			System::Net::Http::HttpClient^ get();
+		}
+	};
+}
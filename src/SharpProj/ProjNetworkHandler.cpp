@@ -1,129 +1,1073 @@
 #include "pch.h"
+#include <sqlite3.h>
+
 #include "ProjContext.h"
+#include "ProjNetwork.h"
+#include "SharedFiles.h"
 
 using namespace SharpProj;
 using namespace System::IO;
-using System::Net::WebRequest;
-using System::Net::WebResponse;
-using System::Net::HttpWebRequest;
-using System::Net::HttpWebResponse;
+using System::Collections::Generic::Dictionary;
+using System::Collections::Generic::KeyValuePair;
+using System::Collections::Generic::IEnumerable;
+using System::Collections::Generic::LinkedList;
+using System::Collections::Generic::LinkedListNode;
+using namespace System::Threading::Tasks;
 using System::Net::HttpStatusCode;
+using System::Net::Http::HttpClient;
+using System::Net::Http::HttpRequestMessage;
+using System::Net::Http::HttpResponseMessage;
+using System::Diagnostics::Stopwatch;
+using System::Diagnostics::Tracing::EventLevel;
+using System::Threading::Interlocked;
+
+namespace SharpProj {
+	// The response to a range request: Length bytes of the resource, starting at Offset. Kept in native memory, so large
+	// ranges don't end up on the large object heap
+	private ref class RangeData sealed
+	{
+	private:
+		size_t m_capacity;
+
+	public:
+		initonly String^ Url;
+		initonly unsigned long long Offset;
+		size_t Length;
+		unsigned char* Data;
+		Dictionary<String^, String^>^ Headers;
+
+		RangeData(String^ url, unsigned long long offset, size_t capacity)
+		{
+			Url = url;
+			Offset = offset;
+			Data = (unsigned char*)malloc(capacity);
+
+			if (!Data)
+				throw gcnew OutOfMemoryException();
+
+			m_capacity = capacity;
+			GC::AddMemoryPressure((long long)capacity);
+		}
+
+	private:
+		~RangeData()
+		{
+			this->!RangeData();
+		}
+
+		!RangeData()
+		{
+			if (Data)
+			{
+				free(Data);
+				Data = nullptr;
+				GC::RemoveMemoryPressure((long long)m_capacity);
+			}
+		}
+
+	public:
+		bool Covers(unsigned long long offset, size_t size)
+		{
+			return offset >= Offset && offset + size <= Offset + Length;
+		}
+	};
+
+	// An outstanding range request. Readers of ranges within it wait for its result instead of fetching themselves
+	private ref class RangeFetch sealed
+	{
+	public:
+		initonly unsigned long long Offset;
+		initonly unsigned long long End;
+		initonly System::Threading::Tasks::TaskCompletionSource<RangeData^>^ Done;
+		int Waiters; // Protected by the InFlight lock
+
+		RangeFetch(unsigned long long offset, unsigned long long end)
+		{
+			Offset = offset;
+			End = end;
+			Done = gcnew System::Threading::Tasks::TaskCompletionSource<RangeData^>();
+		}
+	};
+
+	// Process wide LRU of fetched ranges, bounded by ProjNetwork::ChunkCacheSize
+	private ref class RangeCache abstract sealed
+	{
+	private:
+		static initonly LinkedList<RangeData^>^ s_lru = gcnew LinkedList<RangeData^>(); // Most recently used first
+		static initonly Dictionary<String^, List<LinkedListNode<RangeData^>^>^>^ s_byUrl = gcnew Dictionary<String^, List<LinkedListNode<RangeData^>^>^>();
+		static long long s_bytes;
+
+	public:
+		static long long Hits;
+		static long long Misses;
+		static long long Evictions;
+
+		static RangeData^ Find(String^ url, unsigned long long offset, size_t size)
+		{
+			List<LinkedListNode<RangeData^>^>^ nodes;
+
+			System::Threading::Monitor::Enter(s_lru);
+			try
+			{
+				if (s_byUrl->TryGetValue(url, nodes))
+				{
+					for each (LinkedListNode<RangeData^> ^ n in nodes)
+					{
+						if (n->Value->Covers(offset, size))
+						{
+							s_lru->Remove(n);
+							s_lru->AddFirst(n);
+							Hits++;
+							return n->Value;
+						}
+					}
+				}
+				return nullptr;
+			}
+			finally
+			{
+				System::Threading::Monitor::Exit(s_lru);
+			}
+		}
+
+		static void Add(RangeData^ rd)
+		{
+			long long limit = ProjNetwork::ChunkCacheSize;
+
+			if ((long long)rd->Length > limit)
+				return;
+
+			System::Threading::Monitor::Enter(s_lru);
+			try
+			{
+				List<LinkedListNode<RangeData^>^>^ nodes;
+
+				if (!s_byUrl->TryGetValue(rd->Url, nodes))
+					s_byUrl[rd->Url] = nodes = gcnew List<LinkedListNode<RangeData^>^>();
+
+				nodes->Add(s_lru->AddFirst(rd));
+				s_bytes += rd->Length;
+
+				while (s_bytes > limit)
+				{
+					// Readers that still use an evicted range keep it alive
+					LinkedListNode<RangeData^>^ last = s_lru->Last;
+					s_lru->RemoveLast();
+					s_bytes -= last->Value->Length;
+					Evictions++;
+
+					nodes = s_byUrl[last->Value->Url];
+					nodes->Remove(last);
+
+					if (!nodes->Count)
+						s_byUrl->Remove(last->Value->Url);
+				}
+			}
+			finally
+			{
+				System::Threading::Monitor::Exit(s_lru);
+			}
+		}
+
+		static void Clear()
+		{
+			System::Threading::Monitor::Enter(s_lru);
+			try
+			{
+				s_lru->Clear();
+				s_byUrl->Clear();
+				s_bytes = 0;
+			}
+			finally
+			{
+				System::Threading::Monitor::Exit(s_lru);
+			}
+		}
+
+		static property long long Bytes
+		{
+			long long get()
+			{
+				return s_bytes;
+			}
+		}
+	};
+
+	// Trace events of the network handler, for ETW/EventPipe listeners
+	[System::Diagnostics::Tracing::EventSource(Name = "SharpProj-Network")]
+	private ref class NetworkEventSource sealed : System::Diagnostics::Tracing::EventSource
+	{
+	public:
+		static initonly NetworkEventSource^ Log = gcnew NetworkEventSource();
+
+		[System::Diagnostics::Tracing::Event(1, Level = EventLevel::Verbose)]
+		void RangeRequest(String^ url, long long offset, long long size, long long bytes, double milliseconds)
+		{
+			WriteEvent(1, gcnew array<Object^> { url, offset, size, bytes, milliseconds });
+		}
+
+		[System::Diagnostics::Tracing::Event(2, Level = EventLevel::Warning)]
+		void RangeRetry(String^ url, int attempt)
+		{
+			WriteEvent(2, url, attempt);
+		}
+
+		[System::Diagnostics::Tracing::Event(3, Level = EventLevel::Error)]
+		void RangeFailed(String^ url, String^ error)
+		{
+			WriteEvent(3, url, error);
+		}
+	};
+
+	// Tracks consecutive failed requests to an endpoint (scheme, host and port). After ProjNetwork::CircuitBreakerThreshold failures
+	// requests fail immediately for ProjNetwork::CircuitBreakerDuration, after which a single trial request is let through
+	private ref class EndpointBreaker sealed
+	{
+	private:
+		static initonly Dictionary<String^, EndpointBreaker^>^ s_endpoints = gcnew Dictionary<String^, EndpointBreaker^>(StringComparer::OrdinalIgnoreCase);
+		int m_failures;
+		long long m_openUntil; // UTC ticks, or 0 when closed
+		bool m_trial;
+
+	public:
+		static EndpointBreaker^ Get(String^ url)
+		{
+			Uri^ uri;
+			String^ key = Uri::TryCreate(url, UriKind::Absolute, uri) ? uri->GetLeftPart(UriPartial::Authority) : url;
+			EndpointBreaker^ b;
+
+			System::Threading::Monitor::Enter(s_endpoints);
+			try
+			{
+				if (!s_endpoints->TryGetValue(key, b))
+					s_endpoints[key] = b = gcnew EndpointBreaker();
+
+				return b;
+			}
+			finally
+			{
+				System::Threading::Monitor::Exit(s_endpoints);
+			}
+		}
+
+		bool Allow()
+		{
+			System::Threading::Monitor::Enter(this);
+			try
+			{
+				if (!m_openUntil)
+					return true;
+				else if (m_trial || DateTime::UtcNow.Ticks < m_openUntil)
+					return false;
+
+				m_trial = true;
+				return true;
+			}
+			finally
+			{
+				System::Threading::Monitor::Exit(this);
+			}
+		}
+
+		void Success()
+		{
+			System::Threading::Monitor::Enter(this);
+			try
+			{
+				m_failures = 0;
+				m_openUntil = 0;
+				m_trial = false;
+			}
+			finally
+			{
+				System::Threading::Monitor::Exit(this);
+			}
+		}
+
+		void Failure()
+		{
+			System::Threading::Monitor::Enter(this);
+			try
+			{
+				int threshold = ProjNetwork::CircuitBreakerThreshold;
+
+				m_trial = false;
+				if (threshold > 0 && ++m_failures >= threshold)
+					m_openUntil = DateTime::UtcNow.Ticks + ProjNetwork::CircuitBreakerDuration.Ticks;
+			}
+			finally
+			{
+				System::Threading::Monitor::Exit(this);
+			}
+		}
+	};
+
+	// Responses are copied to their destination through a small per thread buffer, below the large object heap threshold
+	private ref class BounceBuffer abstract sealed
+	{
+	private:
+		[System::ThreadStatic]
+		static array<Byte>^ t_buffer;
+
+	public:
+		static array<Byte>^ Get()
+		{
+			if (!t_buffer)
+				t_buffer = gcnew array<Byte>(64 * 1024);
+
+			return t_buffer;
+		}
+	};
+
+	private ref class RangeFetches abstract sealed
+	{
+	public:
+		static initonly Dictionary<String^, List<RangeFetch^>^>^ InFlight = gcnew Dictionary<String^, List<RangeFetch^>^>();
+	};
+}
 
 struct my_network_data
 {
 	gcroot<ProjContext^> ctx;
 	gcroot<String^> url;
-	gcroot<System::Net::WebResponse^> rp;
+	gcroot<Dictionary<String^, String^>^> headers;
+	gcroot<RangeData^> ahead; // The last fetched range, which may contain the next reads
+	unsigned long long next_offset;
+	size_t ahead_size;
 	void* chain;
+	shared_file* local; // Set when the url refers to a file in a local mirror
 };
 
-
-static PROJ_NETWORK_HANDLE* my_network_open(
-	PJ_CONTEXT* ctx,
-	const char* url,
-	unsigned long long offset,
-	size_t size_to_read,
-	void* buffer,
-	size_t* out_size_read,
-	size_t error_string_max_size,
-	char* out_error_string,
-	void* user_data)
+HttpClient^ ProjNetwork::Client::get()
 {
-	gcroot<WeakReference<ProjContext^>^>& ref = *(gcroot<WeakReference<ProjContext^>^>*)user_data;
-	ProjContext^ pc;
-	if (!ref->TryGetTarget(pc))
+	if (!s_client)
 	{
-		strncpy_s(out_error_string, error_string_max_size, "Already disposed", error_string_max_size);
-		return nullptr;
+		System::Threading::Monitor::Enter(s_lock);
+		try
+		{
+			if (!s_client)
+			{
+				System::Net::Http::HttpClientHandler^ handler = gcnew System::Net::Http::HttpClientHandler();
+				handler->UseCookies = false;
+				handler->AllowAutoRedirect = true;
+
+				HttpClient^ client = gcnew HttpClient(handler);
+				client->Timeout = System::Threading::Timeout::InfiniteTimeSpan; // Applied per request
+				client->DefaultRequestHeaders->TryAddWithoutValidation("User-Agent", "System.Net/SharpProj using PROJ " PROJ_VERSION);
+
+				s_client = client;
+			}
+		}
+		finally
+		{
+			System::Threading::Monitor::Exit(s_lock);
+		}
 	}
+	return s_client;
+}
 
-	if (error_string_max_size > 0 && out_error_string)
-		out_error_string[0] = '\0';
+long long ProjNetwork::ChunkCacheHits::get()
+{
+	return System::Threading::Interlocked::Read(RangeCache::Hits);
+}
 
+long long ProjNetwork::ChunkCacheMisses::get()
+{
+	return System::Threading::Interlocked::Read(RangeCache::Misses);
+}
 
-	String^ sUrl = Utf8_PtrToString(url);
-	WebRequest^ rq = WebRequest::Create(sUrl);
-	HttpWebRequest^ hrq = dynamic_cast<HttpWebRequest^>(rq);
+long long ProjNetwork::ChunkCacheEvictions::get()
+{
+	return System::Threading::Interlocked::Read(RangeCache::Evictions);
+}
+
+long long ProjNetwork::ChunkCacheBytes::get()
+{
+	return RangeCache::Bytes;
+}
+
+void ProjNetwork::ClearChunkCache()
+{
+	RangeCache::Clear();
+}
+
+TimeSpan ProjNetwork::RetryDelay(int attempt)
+{
+	if (!t_random)
+		t_random = gcnew Random(System::Threading::Thread::CurrentThread->ManagedThreadId ^ Environment::TickCount);
+
+	// Exponential, with the upper half jittered to spread retries of many readers
+	double ms = Math::Min(s_retryDelay.TotalMilliseconds * Math::Pow(2, attempt), 10000.0);
+	return TimeSpan::FromMilliseconds(ms / 2 + t_random->NextDouble() * ms / 2);
+}
+
+ProjIOStatistics^ ProjNetwork::GetStatistics()
+{
+	long long reads, bytes, ticks;
+
+	shared_file_api_statistics(&reads, &bytes, &ticks);
+
+	return gcnew ProjIOStatistics(NetworkCounters::Process, reads, bytes, ticks, shared_file_mappings(), shared_sqlite_fetches());
+}
+
+ProjIOStatistics^ ProjContext::IOStatistics::get()
+{
+	return gcnew ProjIOStatistics(m_networkCounters, 0, 0, 0, 0, 0);
+}
+
+ProjIOStatistics::ProjIOStatistics(NetworkCounters^ c, long long fileReads, long long fileBytes, long long fileTicks, long long fileMappings, long long databaseFetches)
+{
+	m_reads = Interlocked::Read(c->Reads);
+	m_readAheadHits = Interlocked::Read(c->ReadAheadHits);
+	m_cacheHits = Interlocked::Read(c->CacheHits);
+	m_localReads = Interlocked::Read(c->LocalReads);
+	m_requests = Interlocked::Read(c->Requests);
+	m_retries = Interlocked::Read(c->Retries);
+	m_failures = Interlocked::Read(c->Failures);
+	m_bytesReceived = Interlocked::Read(c->BytesReceived);
+	m_blockedTicks = Interlocked::Read(c->BlockedTicks);
+	m_latency = gcnew array<long long>(c->Latency->Length);
+	for (int i = 0; i < m_latency->Length; i++)
+		m_latency[i] = Interlocked::Read(c->Latency[i]);
+
+	m_fileReads = fileReads;
+	m_fileBytes = fileBytes;
+	m_fileTicks = fileTicks;
+	m_fileMappings = fileMappings;
+	m_databaseFetches = databaseFetches;
+}
+
+array<TimeSpan>^ ProjIOStatistics::LatencyBucketLimits::get()
+{
+	array<TimeSpan>^ limits = gcnew array<TimeSpan>(NetworkCounters::LatencyBuckets);
+
+	for (int i = 0; i < limits->Length - 1; i++)
+		limits[i] = TimeSpan::FromMilliseconds(1 << i);
+
+	limits[limits->Length - 1] = TimeSpan::MaxValue;
+	return limits;
+}
 
-	if (hrq != nullptr)
+static long long elapsed_ticks(long long start)
+{
+	return (long long)((Stopwatch::GetTimestamp() - start) * ((double)TimeSpan::TicksPerSecond / Stopwatch::Frequency));
+}
+
+static void count_request(NetworkCounters^ c, size_t bytes, int bucket)
+{
+	Interlocked::Increment(c->Requests);
+	Interlocked::Add(c->BytesReceived, (long long)bytes);
+	Interlocked::Increment(c->Latency[bucket]);
+}
+
+// Counts a single http request (attempt) in the context and process wide counters
+static void count_request(ProjContext^ pc, String^ url, unsigned long long offset, size_t size, size_t bytes, long long ticks)
+{
+	// Bucket i counts latencies below 2^i ms, the last one all others
+	int bucket = 0;
+	for (long long ms = ticks / TimeSpan::TicksPerMillisecond; ms > 0 && bucket < NetworkCounters::LatencyBuckets - 1; ms >>= 1)
+		bucket++;
+
+	count_request(pc->m_networkCounters, bytes, bucket);
+	count_request(NetworkCounters::Process, bytes, bucket);
+
+	if (NetworkEventSource::Log->IsEnabled())
+		NetworkEventSource::Log->RangeRequest(url, offset, size, bytes, TimeSpan(ticks).TotalMilliseconds);
+}
+
+static void count_read(NetworkCounters^ c, bool local, long long ticks)
+{
+	Interlocked::Increment(c->Reads);
+	Interlocked::Add(c->BlockedTicks, ticks);
+
+	if (local)
+		Interlocked::Increment(c->LocalReads);
+}
+
+// Counts a read callback from PROJ, which blocked the calling transform for ticks
+static void count_read(ProjContext^ pc, bool local, long long ticks)
+{
+	count_read(pc->m_networkCounters, local, ticks);
+	count_read(NetworkCounters::Process, local, ticks);
+}
+
+static void set_error(char* out_error_string, size_t error_string_max_size, const char* msg)
+{
+	if (out_error_string && error_string_max_size > 0)
+		strncpy_s(out_error_string, error_string_max_size, msg, _TRUNCATE);
+}
+
+static void add_headers(Dictionary<String^, String^>^ to, IEnumerable<KeyValuePair<String^, IEnumerable<String^>^>>^ headers)
+{
+	for each (KeyValuePair<String^, IEnumerable<String^>^> h in headers)
 	{
-		hrq->UserAgent = "System.Net/SharpProj using PROJ " PROJ_VERSION;
-		hrq->AddRange((long long)offset, (long long)(offset + size_to_read));
+		to[h.Key] = String::Join(", ", h.Value);
 	}
-	else
-		rq->Headers->Add(String::Format("Range: bytes={0}-{1}", offset, offset + size_to_read - 1));
+}
 
-	WebResponse^ rp;
-	bool in_error = true;
+// A single attempt of http_fetch_range. Sets retry when the failure may be transient.
+// PROJ calls us synchronously, so the calling thread blocks. But the waits (and their timeouts) don't depend on other thread pool
+// threads: the request completes on an I/O thread, and the response is read synchronously with a read timeout.
+static size_t http_fetch_once(
+	ProjContext^ pc,
+	String^ url,
+	unsigned long long offset,
+	size_t size,
+	unsigned char* target,
+	Dictionary<String^, String^>^% headers,
+	bool% retry,
+	size_t error_string_max_size,
+	char* out_error_string)
+{
+	retry = false;
+
+	HttpRequestMessage^ rq = gcnew HttpRequestMessage(System::Net::Http::HttpMethod::Get, url);
+	rq->Headers->Range = gcnew System::Net::Http::Headers::RangeHeaderValue((long long)offset, (long long)(offset + size - 1));
 
+	System::Threading::CancellationTokenSource^ cts = gcnew System::Threading::CancellationTokenSource();
+	HttpResponseMessage^ rp = nullptr;
+	int timeout = (int)ProjNetwork::Timeout.TotalMilliseconds; // -1 when infinite
+	Stopwatch^ sw = Stopwatch::StartNew();
 	try
 	{
-		rp = rq->GetResponse();
-		in_error = false;
+		System::Threading::Tasks::Task<HttpResponseMessage^>^ send
+			= ProjNetwork::Client->SendAsync(rq, System::Net::Http::HttpCompletionOption::ResponseHeadersRead, cts->Token);
+
+		if (!((IAsyncResult^)send)->AsyncWaitHandle->WaitOne(timeout))
+		{
+			cts->Cancel();
+			throw gcnew System::OperationCanceledException();
+		}
+
+		rp = send->GetAwaiter().GetResult(); // Completed; throws on failure
+
+		if (rp->StatusCode != HttpStatusCode::PartialContent)
+		{
+			int status = (int)rp->StatusCode;
+			retry = (status >= 500 || status == 408 || status == 429);
+
+			pc->OnLogMessage(ProjLogLevel::Debug, String::Format("{0}: HTTP {1} {2}", url, (int)rp->StatusCode, rp->ReasonPhrase));
+			set_error(out_error_string, error_string_max_size, rp->IsSuccessStatusCode ? "No partial web response" : "Http error");
+			return 0;
+		}
+
+		headers = gcnew Dictionary<String^, String^>(StringComparer::OrdinalIgnoreCase);
+		add_headers(headers, rp->Headers);
+		add_headers(headers, rp->Content->Headers);
+
+		Stream^ s = rp->Content->ReadAsStreamAsync()->GetAwaiter().GetResult(); // The response stream, already available
+		array<Byte>^ bounce = BounceBuffer::Get();
+		size_t r = 0;
+
+		while (r < size)
+		{
+			if (timeout >= 0)
+			{
+				long long left = timeout - sw->ElapsedMilliseconds;
+
+				if (left <= 0)
+					throw gcnew System::OperationCanceledException();
+				else if (s->CanTimeout)
+					s->ReadTimeout = (int)left;
+			}
+
+			int n = s->Read(bounce, 0, (int)Math::Min((size_t)bounce->Length, size - r));
+
+			if (n <= 0)
+				break; // End of resource
+
+			pin_ptr<Byte> pBounce = &bounce[0];
+			memcpy(target + r, pBounce, n);
+			r += n;
+		}
+
+		if (!r)
+		{
+			retry = true;
+			set_error(out_error_string, error_string_max_size, "Read error");
+		}
+
+		return r;
 	}
-	catch (System::Net::WebException^ wx)
+	catch (System::OperationCanceledException^)
 	{
-		pc->OnLogMessage(ProjLogLevel::Debug, wx->ToString());
-		rp = wx->Response;
+		retry = true;
+		pc->OnLogMessage(ProjLogLevel::Debug, String::Format("{0}: Timeout", url));
+		set_error(out_error_string, error_string_max_size, "Timeout");
+		return 0;
 	}
 	catch (Exception^ ex)
 	{
+		if (dynamic_cast<IOException^>(ex) && timeout >= 0 && sw->ElapsedMilliseconds >= timeout)
+		{
+			retry = true; // The read timeout expired
+			pc->OnLogMessage(ProjLogLevel::Debug, String::Format("{0}: Timeout", url));
+			set_error(out_error_string, error_string_max_size, "Timeout");
+			return 0;
+		}
+
+		// Connection failures, resets and broken responses
+		retry = (dynamic_cast<System::Net::Http::HttpRequestException^>(ex) != nullptr || dynamic_cast<IOException^>(ex) != nullptr
+			|| dynamic_cast<System::Net::WebException^>(ex) != nullptr);
 		pc->OnLogMessage(ProjLogLevel::Debug, ex->ToString());
-		rp = nullptr;
+		set_error(out_error_string, error_string_max_size, "Http error");
+		return 0;
+	}
+	finally
+	{
+		delete rp;
+		delete cts;
+		delete rq;
 	}
+}
 
-	HttpWebResponse^ hrp = dynamic_cast<HttpWebResponse^>(rp);
+static void count_failure(ProjContext^ pc, String^ url, const char* error)
+{
+	Interlocked::Increment(pc->m_networkCounters->Failures);
+	Interlocked::Increment(NetworkCounters::Process->Failures);
+
+	if (NetworkEventSource::Log->IsEnabled())
+		NetworkEventSource::Log->RangeFailed(url, error ? Utf8_PtrToString(error) : nullptr);
+}
 
-	if (hrp && hrp->StatusCode == HttpStatusCode::PartialContent)
+// Fetches the range [offset, offset+size) of url via the shared client, streaming the response into target. Transient failures
+// are retried with jittered exponential backoff, and endpoints that keep failing are skipped for a while. Returns the number of
+// bytes read, or 0 after setting the error
+static size_t http_fetch_range(
+	ProjContext^ pc,
+	String^ url,
+	unsigned long long offset,
+	size_t size,
+	unsigned char* target,
+	Dictionary<String^, String^>^% headers,
+	size_t error_string_max_size,
+	char* out_error_string)
+{
+	EndpointBreaker^ breaker = EndpointBreaker::Get(url);
+
+	if (!breaker->Allow())
+	{
+		pc->OnLogMessage(ProjLogLevel::Debug, String::Format("{0}: Endpoint unavailable", url));
+		set_error(out_error_string, error_string_max_size, "Endpoint unavailable");
+		count_failure(pc, url, out_error_string);
+		return 0;
+	}
+
+	for (int attempt = 0; ; attempt++)
 	{
-		System::IO::Stream^ s = hrp->GetResponseStream();
-		array<unsigned char>^ buf = gcnew array<unsigned char>(size_to_read);
+		bool retry;
+		long long start = Stopwatch::GetTimestamp();
+		size_t r = http_fetch_once(pc, url, offset, size, target, headers, retry, error_string_max_size, out_error_string);
 
-		int r = s->Read(buf, 0, size_to_read);
+		count_request(pc, url, offset, size, r, elapsed_ticks(start));
 
-		while (r > 0 && r < size_to_read)
+		if (r)
 		{
-			int n = s->Read(buf, r, size_to_read - r);
+			breaker->Success();
+			return r;
+		}
+		else if (!retry)
+		{
+			breaker->Success(); // The server answered
+			count_failure(pc, url, out_error_string);
+			return 0;
+		}
+		else if (attempt >= ProjNetwork::MaxRetries)
+		{
+			breaker->Failure();
+			count_failure(pc, url, out_error_string);
+			return 0;
+		}
 
-			if (n > 0)
-				r += n;
-			else
+		Interlocked::Increment(pc->m_networkCounters->Retries);
+		Interlocked::Increment(NetworkCounters::Process->Retries);
+		if (NetworkEventSource::Log->IsEnabled())
+			NetworkEventSource::Log->RangeRetry(url, attempt + 1);
+
+		// PROJ's read callback is synchronous, so the backoff can only block this thread
+		System::Threading::Thread::Sleep(ProjNetwork::RetryDelay(attempt));
+	}
+}
+
+// Reads [offset, offset+size) of url into buffer, by joining a fetch in flight for the same url that covers it, or by fetching
+// [offset, offset+span) ourselves. When span is larger than size the fetched range is returned via ahead, for serving the next reads.
+// Without read-ahead and chunk cache the response is streamed directly into buffer, and only copied when other readers wait for it.
+// Otherwise it is streamed into the range kept for them, and copied out of it once.
+static size_t fetch_range(
+	ProjContext^ pc,
+	String^ url,
+	unsigned long long offset,
+	size_t size,
+	size_t span,
+	void* buffer,
+	RangeData^% ahead,
+	Dictionary<String^, String^>^% headers,
+	size_t error_string_max_size,
+	char* out_error_string)
+{
+	bool cache = (ProjNetwork::ChunkCacheSize > 0);
+	RangeData^ rd = cache ? RangeCache::Find(url, offset, size) : nullptr;
+
+	if (rd)
+	{
+		Interlocked::Increment(pc->m_networkCounters->CacheHits);
+		Interlocked::Increment(NetworkCounters::Process->CacheHits);
+
+		memcpy(buffer, rd->Data + (offset - rd->Offset), size);
+		ahead = rd;
+		headers = rd->Headers;
+		GC::KeepAlive(rd);
+		return size;
+	}
+
+	Dictionary<String^, List<RangeFetch^>^>^ inFlight = RangeFetches::InFlight;
+	List<RangeFetch^>^ fetches;
+	RangeFetch^ fetch = nullptr;
+	bool own = false;
+
+	System::Threading::Monitor::Enter(inFlight);
+	try
+	{
+		if (!inFlight->TryGetValue(url, fetches))
+			inFlight[url] = fetches = gcnew List<RangeFetch^>();
+
+		for each (RangeFetch ^ f in fetches)
+		{
+			if (f->Offset <= offset && offset + size <= f->End)
+			{
+				fetch = f;
+				fetch->Waiters++;
 				break;
+			}
 		}
 
-		if (r > 0)
+		if (!fetch)
 		{
-			pin_ptr<unsigned char> pBuf = &buf[0];
-			memcpy(buffer, pBuf, r);
-			*out_size_read = r;
+			fetch = gcnew RangeFetch(offset, offset + span);
+			fetches->Add(fetch);
+			own = true;
 		}
-		else
+	}
+	finally
+	{
+		System::Threading::Monitor::Exit(inFlight);
+	}
+
+	if (!own)
+	{
+		rd = fetch->Done->Task->Result;
+
+		// The range may be shorter than requested at the end of the resource
+		if (!rd || offset < rd->Offset || offset >= rd->Offset + rd->Length)
 		{
-			strncpy_s(out_error_string, error_string_max_size, "Read error", error_string_max_size);
-			*out_size_read = 0;
-			return nullptr;
+			set_error(out_error_string, error_string_max_size, "Http error");
+			return 0;
 		}
 
+		ahead = rd;
 	}
-	else if (!in_error)
+	else
 	{
-		strncpy_s(out_error_string, error_string_max_size, "No partial web response", error_string_max_size);
-		return nullptr;
+		bool direct = (span == size && !cache);
+		size_t r = 0;
+		int waiters = 0;
+
+		System::Threading::Interlocked::Increment(RangeCache::Misses);
+
+		try
+		{
+			if (direct)
+				r = http_fetch_range(pc, url, offset, size, (unsigned char*)buffer, headers, error_string_max_size, out_error_string);
+			else
+			{
+				rd = gcnew RangeData(url, offset, span);
+				r = http_fetch_range(pc, url, offset, span, rd->Data, headers, error_string_max_size, out_error_string);
+			}
+		}
+		finally
+		{
+			System::Threading::Monitor::Enter(inFlight);
+			try
+			{
+				fetches->Remove(fetch);
+
+				if (!fetches->Count)
+					inFlight->Remove(url);
+
+				waiters = fetch->Waiters;
+			}
+			finally
+			{
+				System::Threading::Monitor::Exit(inFlight);
+			}
+
+			if (!r)
+				rd = nullptr;
+			else if (direct && waiters)
+			{
+				// Others wait for this range. Give them a copy
+				rd = gcnew RangeData(url, offset, r);
+				memcpy(rd->Data, buffer, r);
+			}
+
+			if (rd)
+			{
+				rd->Length = r;
+				rd->Headers = headers;
+
+				if (cache)
+					RangeCache::Add(rd);
+			}
+
+			fetch->Done->SetResult(rd);
+		}
+
+		if (direct)
+			return r;
+		else if (!r)
+			return 0;
+
+		ahead = rd;
+	}
+
+	size_t n = (size_t)Math::Min((unsigned long long)size, rd->Offset + rd->Length - offset);
+
+	memcpy(buffer, rd->Data + (offset - rd->Offset), n);
+	headers = rd->Headers;
+	GC::KeepAlive(rd);
+	return n;
+}
+
+// Serves [offset, offset+size) for the handle from its read-ahead range, or fetches it. Sequential reads double the
+// read-ahead span up to ProjNetwork::MaxReadAheadSize, other reads reset it.
+static size_t network_read(
+	my_network_data* d,
+	unsigned long long offset,
+	size_t size,
+	void* buffer,
+	size_t error_string_max_size,
+	char* out_error_string)
+{
+	if (!size)
+	{
+		set_error(out_error_string, error_string_max_size, "Empty read");
+		return 0;
+	}
+
+	RangeData^ rd = d->ahead;
+	size_t n;
+
+	if (rd && rd->Covers(offset, size))
+	{
+		Interlocked::Increment(d->ctx->m_networkCounters->ReadAheadHits);
+		Interlocked::Increment(NetworkCounters::Process->ReadAheadHits);
+
+		n = size;
+		memcpy(buffer, rd->Data + (offset - rd->Offset), n);
+		GC::KeepAlive(rd);
 	}
 	else
 	{
-		strncpy_s(out_error_string, error_string_max_size, "Http error", error_string_max_size);
+		if (offset == d->next_offset)
+			d->ahead_size = Math::Min(Math::Max(d->ahead_size * 2, size), Math::Max((size_t)ProjNetwork::MaxReadAheadSize, size));
+		else
+			d->ahead_size = size;
+
+		RangeData^ ahead = nullptr;
+		Dictionary<String^, String^>^ headers = nullptr;
+
+		n = fetch_range(d->ctx, d->url, offset, size, d->ahead_size, buffer, ahead, headers, error_string_max_size, out_error_string);
+
+		if (!n)
+			return 0;
+
+		d->ahead = ahead;
+		d->headers = headers;
+	}
+
+	d->next_offset = offset + n;
+	return n;
+}
+
+// PROJ only passes http(s) urls to the network callbacks, and opens other endpoints as plain files. A local mirror is therefore
+// handed to PROJ as (escaped) path below this prefix
+static const char mirror_prefix[] = "http://sharpproj-mirror.invalid/";
+
+// Returns the local file url refers to when the endpoint is a local mirror, otherwise nullptr
+static String^ local_mirror_path(String^ url)
+{
+	if (!url->StartsWith(gcnew String(mirror_prefix), StringComparison::OrdinalIgnoreCase))
 		return nullptr;
+
+	return Uri::UnescapeDataString(url->Substring(sizeof(mirror_prefix) - 1))->Replace('/', Path::DirectorySeparatorChar);
+}
+
+String^ ProjContext::EndpointUrl::get()
+{
+	const char* c = proj_context_get_url_endpoint(this);
+
+	if (!c || !*c)
+		return nullptr;
+
+	String^ url = Utf8_PtrToString(c);
+	String^ local = local_mirror_path(url);
+
+	return local ? local : url;
+}
+
+void ProjContext::EndpointUrl::set(String^ value)
+{
+	Uri^ uri;
+	String^ local = nullptr;
+
+	if (!value)
+	{
+	}
+	else if (Uri::TryCreate(value, UriKind::Absolute, uri))
+		local = uri->IsFile ? uri->LocalPath : nullptr;
+	else
+		local = Path::GetFullPath(value);
+
+	if (local)
+		value = gcnew String(mirror_prefix) + Uri::EscapeDataString(local->TrimEnd(Path::DirectorySeparatorChar, Path::AltDirectorySeparatorChar));
+
+	utf8_str url(value);
+
+	proj_context_set_url_endpoint(this, url.c_str());
+}
+
+// Serves [offset, offset+size) from the mapped mirror file, with the headers a server would have returned
+static size_t local_read(
+	my_network_data* d,
+	unsigned long long offset,
+	size_t size,
+	void* buffer,
+	size_t error_string_max_size,
+	char* out_error_string)
+{
+	unsigned long long total = shared_file_size(d->local);
+
+	if (!size || offset >= total)
+	{
+		set_error(out_error_string, error_string_max_size, "Range not satisfiable");
+		return 0;
+	}
+
+	size_t n = (size_t)Math::Min((unsigned long long)size, total - offset);
+	memcpy(buffer, shared_file_data(d->local) + offset, n);
+
+	Dictionary<String^, String^>^ headers = d->headers;
+	headers["Content-Length"] = n.ToString();
+	headers["Content-Range"] = String::Format("bytes {0}-{1}/{2}", offset, offset + n - 1, total);
+
+	return n;
+}
+
+static PROJ_NETWORK_HANDLE* network_open(
+	ProjContext^ pc,
+	const char* url,
+	unsigned long long offset,
+	size_t size_to_read,
+	void* buffer,
+	size_t* out_size_read,
+	size_t error_string_max_size,
+	char* out_error_string)
+{
+	String^ sUrl = Utf8_PtrToString(url);
+	String^ localPath = local_mirror_path(sUrl);
+	Uri^ uri;
+
+	if (localPath)
+	{
+		utf8_str path(localPath);
+		shared_file* local = shared_file_open(path.c_str());
+
+		if (!local)
+		{
+			pc->OnLogMessage(ProjLogLevel::Debug, String::Format("{0}: Not found in local mirror", localPath));
+			set_error(out_error_string, error_string_max_size, "Not found");
+			return nullptr;
+		}
+
+		my_network_data* d = new my_network_data();
+		d->ctx = pc;
+		d->url = sUrl;
+		d->next_offset = offset;
+		d->ahead_size = 0;
+		d->chain = nullptr;
+		d->local = local;
+
+		Dictionary<String^, String^>^ headers = gcnew Dictionary<String^, String^>(StringComparer::OrdinalIgnoreCase);
+		DateTime modified = File::GetLastWriteTimeUtc(localPath);
+		headers["Last-Modified"] = modified.ToString("R", System::Globalization::CultureInfo::InvariantCulture);
+		headers["ETag"] = String::Format("\"{0:x}-{1:x}\"", modified.Ticks, shared_file_size(local));
+		d->headers = headers;
+
+		*out_size_read = local_read(d, offset, size_to_read, buffer, error_string_max_size, out_error_string);
+
+		if (!*out_size_read)
+		{
+			shared_file_release(local);
+			delete d;
+			return nullptr;
+		}
+
+		pc->OnLogMessage(ProjLogLevel::Debug, String::Format("{0}: Local mirror, Content-Range: {1}", localPath, headers["Content-Range"]));
+		return (PROJ_NETWORK_HANDLE*)(void*)d;
+	}
+	else if (Uri::TryCreate(sUrl, UriKind::Absolute, uri) && (uri->Scheme == Uri::UriSchemeHttp || uri->Scheme == Uri::UriSchemeHttps))
+	{
+		// .Net Framework pools the connections per service point
+		System::Net::ServicePointManager::FindServicePoint(uri)->ConnectionLimit = ProjNetwork::MaxConnectionsPerServer;
 	}
 
 	my_network_data* d = new my_network_data();
 	d->ctx = pc;
 	d->url = sUrl;
-	d->rp = rp;
+	d->next_offset = offset;
+	d->ahead_size = size_to_read;
 	d->chain = nullptr;
+	d->local = nullptr;
+
+	*out_size_read = network_read(d, offset, size_to_read, buffer, error_string_max_size, out_error_string);
+
+	if (!*out_size_read)
+	{
+		delete d;
+		return nullptr;
+	}
+
 	return (PROJ_NETWORK_HANDLE*)(void*)d;
 }
 
+static PROJ_NETWORK_HANDLE* my_network_open(
+	PJ_CONTEXT* ctx,
+	const char* url,
+	unsigned long long offset,
+	size_t size_to_read,
+	void* buffer,
+	size_t* out_size_read,
+	size_t error_string_max_size,
+	char* out_error_string,
+	void* user_data)
+{
+	gcroot<WeakReference<ProjContext^>^>& ref = *(gcroot<WeakReference<ProjContext^>^>*)user_data;
+	ProjContext^ pc;
+	if (!ref->TryGetTarget(pc))
+	{
+		set_error(out_error_string, error_string_max_size, "Already disposed");
+		return nullptr;
+	}
+
+	set_error(out_error_string, error_string_max_size, "");
+
+	long long start = Stopwatch::GetTimestamp();
+	PROJ_NETWORK_HANDLE* h = network_open(pc, url, offset, size_to_read, buffer, out_size_read, error_string_max_size, out_error_string);
+
+	count_read(pc, h && ((my_network_data*)h)->local, elapsed_ticks(start));
+	return h;
+}
+
 static void my_network_close(
 	PJ_CONTEXT* ctx,
 	PROJ_NETWORK_HANDLE* handle,
@@ -133,6 +1077,9 @@ static void my_network_close(
 
 	d->ctx->free_chain(d->chain);
 
+	if (d->local)
+		shared_file_release(d->local);
+
 	delete d;
 }
 
@@ -143,10 +1090,10 @@ const char* my_network_get_header_value(
 	void* user_data)
 {
 	my_network_data* d = (my_network_data*)handle;
+	Dictionary<String^, String^>^ headers = d->headers;
+	String^ h;
 
-	String^ h = d->rp->Headers->Get(Utf8_PtrToString(header_name));
-
-	if (h)
+	if (headers && headers->TryGetValue(Utf8_PtrToString(header_name), h))
 	{
 		return d->ctx->utf8_chain(h, d->chain);
 	}
@@ -165,134 +1112,394 @@ size_t my_network_read_range(
 	void* user_data)
 {
 	my_network_data* d = (my_network_data*)handle;
+	long long start = Stopwatch::GetTimestamp();
+	size_t n;
 
-	if (error_string_max_size > 0 && out_error_string)
-		out_error_string[0] = '\0';
+	set_error(out_error_string, error_string_max_size, "");
 
-	delete d->rp;
-	d->rp = nullptr;
+	if (d->local)
+		n = local_read(d, offset, size_to_read, buffer, error_string_max_size, out_error_string);
+	else
+		n = network_read(d, offset, size_to_read, buffer, error_string_max_size, out_error_string);
 
-	WebRequest^ rq = WebRequest::Create(d->url);
-	HttpWebRequest^ hrq = dynamic_cast<HttpWebRequest^>(rq);
+	count_read(d->ctx, d->local != nullptr, elapsed_ticks(start));
+	return n;
+}
 
-	if (hrq != nullptr)
-	{
-		hrq->AddRange((long long)offset, (long long)(offset + size_to_read));
-	}
-	else
-		rq->Headers->Add(String::Format("Range: bytes={0}-{1}", offset, offset + size_to_read - 1));
+void ProjContext::SetupNetworkHandling()
+{
+	m_networkCounters = gcnew NetworkCounters();
 
-	WebResponse^ rp;
-	bool in_error = true;
+	proj_context_set_network_callbacks(
+		m_ctx,
+		my_network_open,
+		my_network_close,
+		my_network_get_header_value,
+		my_network_read_range,
+		m_ref);
+}
 
-	try
-	{
-		rp = rq->GetResponse();
-		in_error = false;
-	}
-	catch (System::Net::WebException^ wx)
-	{
-		d->ctx->OnLogMessage(ProjLogLevel::Debug, wx->ToString());
-		rp = wx->Response;
-	}
-	catch (Exception^ ex)
+// Checks that path is a readable, uncorrupted SQLite database
+static bool sqlite_quick_check(String^ path)
+{
+	utf8_str p(path);
+	sqlite3* db = nullptr;
+	bool ok = false;
+
+	if (SQLITE_OK == sqlite3_open_v2(p.c_str(), &db, SQLITE_OPEN_READONLY, nullptr))
 	{
-		d->ctx->OnLogMessage(ProjLogLevel::Debug, ex->ToString());
-		rp = nullptr;
+		sqlite3_stmt* stmt;
+
+		if (SQLITE_OK == sqlite3_prepare_v2(db, "PRAGMA quick_check", -1, &stmt, nullptr))
+		{
+			const char* r = (SQLITE_ROW == sqlite3_step(stmt)) ? (const char*)sqlite3_column_text(stmt, 0) : nullptr;
+
+			ok = r && !strcmp(r, "ok");
+			sqlite3_finalize(stmt);
+		}
 	}
 
-	HttpWebResponse^ hrp = dynamic_cast<HttpWebResponse^>(rp);
+	sqlite3_close(db);
+	return ok;
+}
 
-	if (hrp && hrp->StatusCode == HttpStatusCode::PartialContent)
+namespace SharpProj {
+	// Downloads the SharpProj.Database package and extracts proj.db to Target. Processes coordinate via an exclusive lock
+	// file next to the target, and an interrupted download resumes from its .part file when the package didn't change
+	private ref class ProjDBDownload sealed
 	{
-		d->rp = rp;
-		System::IO::Stream^ s = hrp->GetResponseStream();
-		array<unsigned char>^ buf = gcnew array<unsigned char>(size_to_read);
+	private:
+		static initonly Dictionary<String^, ProjDBDownload^>^ s_running = gcnew Dictionary<String^, ProjDBDownload^>(StringComparer::OrdinalIgnoreCase);
+		initonly String^ m_target;
+		initonly List<IProgress<double>^>^ m_progress;
+		Task<String^>^ m_task;
 
-		int r = s->Read(buf, 0, size_to_read);
+		ProjDBDownload(String^ target)
+		{
+			m_target = target;
+			m_progress = gcnew List<IProgress<double>^>();
+		}
 
-		while (r > 0 && r < size_to_read)
+	public:
+		// Starts downloading to target, or joins the download to target that is already running in this process. The download
+		// itself can't be cancelled, as others may wait for it. cancel only ends the wait of this caller
+		static Task<String^>^ Start(String^ target, IProgress<double>^ progress, System::Threading::CancellationToken cancel)
 		{
-			int n = s->Read(buf, r, size_to_read - r);
+			ProjDBDownload^ dl;
 
-			if (n > 0)
-				r += n;
-			else
-				break;
+			System::Threading::Monitor::Enter(s_running);
+			try
+			{
+				if (!s_running->TryGetValue(target, dl))
+				{
+					dl = gcnew ProjDBDownload(target);
+					s_running[target] = dl;
+				}
+
+				if (progress)
+					dl->m_progress->Add(progress);
+
+				if (!dl->m_task)
+					dl->m_task = Task::Run<String^>(gcnew Func<String^>(dl, &ProjDBDownload::Run));
+			}
+			finally
+			{
+				System::Threading::Monitor::Exit(s_running);
+			}
+
+			return CancellableWait::Create(dl->m_task, cancel);
 		}
 
-		if (r > 0)
+	private:
+		// Completes with the download, or as cancelled when the token of the caller is cancelled first
+		ref class CancellableWait sealed
 		{
-			pin_ptr<unsigned char> pBuf = &buf[0];
-			memcpy(buffer, pBuf, r);
-			return r;
+		private:
+			initonly System::Threading::Tasks::TaskCompletionSource<String^>^ m_done;
+			initonly System::Threading::CancellationToken m_cancel;
+			System::Threading::CancellationTokenRegistration m_registration;
+
+			CancellableWait(System::Threading::CancellationToken cancel)
+			{
+				m_done = gcnew System::Threading::Tasks::TaskCompletionSource<String^>();
+				m_cancel = cancel;
+			}
+
+			void Cancelled()
+			{
+				m_done->TrySetCanceled(m_cancel);
+			}
+
+			void Completed(Task<String^>^ task)
+			{
+				m_registration.Dispose();
+
+				if (task->IsFaulted)
+					m_done->TrySetException(task->Exception->InnerExceptions);
+				else if (task->IsCanceled)
+					m_done->TrySetCanceled();
+				else
+					m_done->TrySetResult(task->Result);
+			}
+
+		public:
+			static Task<String^>^ Create(Task<String^>^ task, System::Threading::CancellationToken cancel)
+			{
+				if (!cancel.CanBeCanceled || task->IsCompleted)
+					return task;
+
+				CancellableWait^ w = gcnew CancellableWait(cancel);
+				w->m_registration = cancel.Register(gcnew Action(w, &CancellableWait::Cancelled));
+				task->ContinueWith(gcnew Action<Task<String^>^>(w, &CancellableWait::Completed), TaskContinuationOptions::ExecuteSynchronously);
+
+				return w->m_done->Task;
+			}
+		};
+
+		void Report(double value)
+		{
+			array<IProgress<double>^>^ progress;
+
+			System::Threading::Monitor::Enter(s_running);
+			try
+			{
+				progress = m_progress->ToArray();
+			}
+			finally
+			{
+				System::Threading::Monitor::Exit(s_running);
+			}
+
+			// Outside the lock, as the callbacks may be slow or start downloads themselves
+			for each (IProgress<double> ^ p in progress)
+				p->Report(value);
 		}
-		else
+
+		String^ Run()
 		{
-			strncpy_s(out_error_string, error_string_max_size, "Read error", error_string_max_size);
-			return 0;
+			try
+			{
+				Directory::CreateDirectory(Path::GetDirectoryName(m_target));
+
+				FileStream^ lock = AcquireLock();
+				try
+				{
+					// Another process may have completed it while we waited
+					if (!File::Exists(m_target))
+						Download();
+				}
+				finally
+				{
+					delete lock;
+				}
+
+				// Contexts may have remembered proj.db as missing
+				ProjContext::ClearFileCache();
+				return m_target;
+			}
+			finally
+			{
+				System::Threading::Monitor::Enter(s_running);
+				try
+				{
+					s_running->Remove(m_target);
+				}
+				finally
+				{
+					System::Threading::Monitor::Exit(s_running);
+				}
+			}
 		}
-	}
-	else if (!in_error)
-	{
-		strncpy_s(out_error_string, error_string_max_size, "No partial web response", error_string_max_size);
-		return 0;
-	}
-	else
-	{
-		strncpy_s(out_error_string, error_string_max_size, "Http error", error_string_max_size);
-		return 0;
-	}
-	return 0;
-}
 
-void ProjContext::SetupNetworkHandling()
-{
-	proj_context_set_network_callbacks(
-		m_ctx,
-		my_network_open,
-		my_network_close,
-		my_network_get_header_value,
-		my_network_read_range,
-		m_ref);
-}
+		FileStream^ AcquireLock()
+		{
+			for (;;)
+			{
+				try
+				{
+					return gcnew FileStream(m_target + ".lock", FileMode::OpenOrCreate, FileAccess::ReadWrite, FileShare::None, 1, FileOptions::DeleteOnClose);
+				}
+				catch (IOException^)
+				{
+					// Held by another process
+				}
 
-void ProjContext::DownloadProjDB(String^ target)
-{
-	using namespace System::IO::Compression;
-	try
-	{
-		WebRequest^ wr = WebRequest::Create("https://www.nuget.org/api/v2/package/SharpProj.Database/" PROJ_VERSION);
+				System::Threading::Thread::Sleep(250);
+			}
+		}
 
-		Stream^ stream = wr->GetResponse()->GetResponseStream();
-		Stream^ sz = nullptr;
-		Stream^ tmp = nullptr;
-		try
+		void Download()
 		{
-			auto za = gcnew System::IO::Compression::ZipArchive(stream, ZipArchiveMode::Read);
+			String^ part = m_target + ".nupkg.part";
+			String^ tmp = m_target + ".tmp";
+
+			Fetch(part);
+
+			try
+			{
+				Extract(part, tmp);
+			}
+			catch (InvalidDataException^)
+			{
+				DeletePart(part); // Corrupt package. Restart the download next time
+				throw;
+			}
 
-			sz = za->GetEntry("contentFiles/any/any/proj.db")->Open();
-			tmp = File::Create(target + ".tmp");
+			if (!sqlite_quick_check(tmp))
+			{
+				File::Delete(tmp);
+				DeletePart(part);
+				throw gcnew InvalidDataException("Downloaded proj.db failed the integrity check");
+			}
 
-			sz->CopyTo(tmp);
-			tmp->Close();
-			tmp = nullptr;
-			delete sz;
-			sz = nullptr;
+			File::Move(tmp, m_target);
+			DeletePart(part);
 
-			File::Move(target + ".tmp", target);
+			Report(1.0);
 		}
-		catch (Exception^)
+
+		static void DeletePart(String^ part)
 		{
-			if (tmp)
-				delete tmp;
-			if (sz)
-				delete sz;
-			if (stream)
-				delete stream;
+			File::Delete(part);
+			File::Delete(part + ".etag");
 		}
-	}
-	catch (Exception^)
-	{
-	}
+
+		// The validator sent as If-Range when resuming: a strong ETag, or else the Last-Modified date
+		static String^ GetValidator(HttpResponseMessage^ rp)
+		{
+			if (rp->Headers->ETag && !rp->Headers->ETag->IsWeak)
+				return rp->Headers->ETag->ToString();
+			else if (rp->Content->Headers->LastModified.HasValue)
+				return rp->Content->Headers->LastModified.Value.ToString("R", System::Globalization::CultureInfo::InvariantCulture);
+			else
+				return nullptr;
+		}
+
+		// Downloads the package to part, continuing after the data a previous attempt left there. The range request is
+		// conditional on the package being the one the part was started from, otherwise the server sends it completely
+		void Fetch(String^ part)
+		{
+			using System::Net::Http::HttpMethod;
+			String^ validatorFile = part + ".etag";
+			String^ validator = File::Exists(validatorFile) ? File::ReadAllText(validatorFile) : nullptr;
+			long long have = (validator && File::Exists(part)) ? (gcnew FileInfo(part))->Length : 0;
+			HttpRequestMessage^ rq = gcnew HttpRequestMessage(HttpMethod::Get, ProjNetwork::ProjDBPackageUrl);
+
+			if (have > 0)
+			{
+				rq->Headers->Range = gcnew System::Net::Http::Headers::RangeHeaderValue(have, Nullable<long long>());
+				rq->Headers->TryAddWithoutValidation("If-Range", validator);
+			}
+
+			HttpResponseMessage^ rp = ProjNetwork::Client->SendAsync(rq, System::Net::Http::HttpCompletionOption::ResponseHeadersRead)->GetAwaiter().GetResult();
+			try
+			{
+				if (have > 0 && rp->StatusCode == HttpStatusCode::RequestedRangeNotSatisfiable)
+					return; // Already complete
+
+				rp->EnsureSuccessStatusCode();
+
+				bool append = (rp->StatusCode == HttpStatusCode::PartialContent);
+
+				if (append && (!rp->Content->Headers->ContentRange || !rp->Content->Headers->ContentRange->From.HasValue
+					|| rp->Content->Headers->ContentRange->From.Value != have))
+				{
+					DeletePart(part);
+					throw gcnew IOException("Unexpected range in proj.db package response");
+				}
+				else if (!append)
+				{
+					// A new (or changed) package. Remember what it was, for resuming
+					String^ v = GetValidator(rp);
+
+					if (v)
+						File::WriteAllText(validatorFile, v);
+					else
+						File::Delete(validatorFile);
+				}
+
+				long long done = append ? have : 0;
+				Nullable<long long> length = rp->Content->Headers->ContentLength;
+				long long total = length.HasValue ? done + length.Value : -1;
+
+				Stream^ from = rp->Content->ReadAsStreamAsync()->GetAwaiter().GetResult();
+				FileStream^ to = gcnew FileStream(part, append ? FileMode::Append : FileMode::Create, FileAccess::Write, FileShare::None);
+				try
+				{
+					array<Byte>^ buffer = gcnew array<Byte>(81920);
+					int n;
+
+					while (0 < (n = from->Read(buffer, 0, buffer->Length)))
+					{
+						to->Write(buffer, 0, n);
+						done += n;
+
+						if (total > 0)
+							Report(0.95 * done / total);
+					}
+				}
+				finally
+				{
+					delete to;
+					delete from;
+				}
+
+				if (total >= 0 && done != total)
+					throw gcnew IOException("Download of proj.db package incomplete");
+			}
+			finally
+			{
+				delete rp;
+			}
+		}
+
+		void Extract(String^ package, String^ tmp)
+		{
+			using namespace System::IO::Compression;
+			ZipArchive^ za = gcnew ZipArchive(File::OpenRead(package), ZipArchiveMode::Read);
+			try
+			{
+				ZipArchiveEntry^ entry = za->GetEntry("contentFiles/any/any/proj.db");
+
+				if (!entry)
+					throw gcnew InvalidDataException("Package doesn't contain proj.db");
+
+				Stream^ from = entry->Open();
+				FileStream^ to = File::Create(tmp);
+				try
+				{
+					from->CopyTo(to);
+
+					if (to->Length != entry->Length)
+						throw gcnew InvalidDataException("proj.db truncated");
+				}
+				finally
+				{
+					delete to;
+					delete from;
+				}
+			}
+			finally
+			{
+				delete za;
+			}
+		}
+	};
+}
+
+String^ ProjContext::DefaultProjDBPath::get()
+{
+	const char* dir = proj_context_get_user_writable_directory(nullptr, false);
+
+	return Path::Combine(Utf8_PtrToString(dir), "proj" PROJ_VERSION "-proj.db");
+}
+
+Task<String^>^ ProjContext::DownloadProjDBAsync(String^ toPath, IProgress<double>^ progress, System::Threading::CancellationToken cancellationToken)
+{
+	return ProjDBDownload::Start(Path::GetFullPath(toPath ? toPath : DefaultProjDBPath), progress, cancellationToken);
+}
+
+void ProjContext::DownloadProjDB(String^ toPath)
+{
+	DownloadProjDBAsync(toPath, nullptr, System::Threading::CancellationToken::None)->GetAwaiter().GetResult();
 }
@@ -19,7 +19,7 @@ ProjObject^ ProjContext::Create(String^ definition)
 	if (String::IsNullOrWhiteSpace(definition))
 		throw gcnew ArgumentNullException("definition");
 
-	std::string fromStr = utf8_string(definition);
+	utf8_str fromStr(definition);
 	PJ* pj = proj_create(this, fromStr.c_str());
 
 	if (!pj)
@@ -33,7 +33,7 @@ ProjObject^ ProjContext::Create(...array<String^>^ from)
 	char** lst = new char* [from->Length + 1];
 	for (int i = 0; i < from->Length; i++)
 	{
-		std::string fromStr = utf8_string(from[i]);
+		utf8_str fromStr(from[i]);
 		lst[i] = _strdup(fromStr.c_str());
 	}
 	lst[from->Length] = 0;
@@ -223,7 +223,7 @@ String^ Identifier::Authority::get()
 	{
 		const char* auth = proj_get_id_auth_name(m_object, m_index);
 
-		m_authority = auth ? Utf8_PtrToString(auth) : nullptr;
+		m_authority = Utf8_PtrToInternedString(auth);
 	}
 	return m_authority;
 }
@@ -234,7 +234,7 @@ String^ Identifier::Name::get()
 	{
 		const char* code = proj_get_id_code(m_object, m_index);
 
-		m_code = Utf8_PtrToString(code);
+		m_code = Utf8_PtrToInternedString(code);
 	}
 	return m_code;
 }
@@ -403,8 +403,7 @@ namespace SharpProj {
 				{
 					if (!m_name)
 					{
-						const char* name = proj_get_name(this);
-						m_name = name ? gcnew System::String(name) : nullptr;
+						m_name = Utf8_PtrToInternedString(proj_get_name(this));
 					}
 					return m_name;
 				}
@@ -436,7 +435,7 @@ namespace SharpProj {
 					{
 						const char* scope = proj_get_scope(this);
 
-						m_scope = Utf8_PtrToString(scope);
+						m_scope = Utf8_PtrToInternedString(scope);
 					}
 					return m_scope;
 				}
@@ -458,7 +457,7 @@ namespace SharpProj {
 					const char* name;
 					if (proj_get_area_of_use(Context, this, &west, &south, &east, &north, &name))
 					{
-						return gcnew Proj::UsageArea(this, west, south, east, north, Utf8_PtrToString(name));
+						return gcnew Proj::UsageArea(this, west, south, east, north, Utf8_PtrToInternedString(name));
 					}
 					else
 						return nullptr;
@@ -0,0 +1,748 @@
+#include "pch.h"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <sqlite3.h>
+#include <cstdio>
+#include <share.h>
+#include <map>
+#include <string>
+
+#include "SharedFiles.h"
+
+#pragma managed(push, off)
+
+namespace SharpProj {
+	struct shared_file
+	{
+		std::string key;
+		const unsigned char* data;
+		unsigned long long size;
+		HANDLE file;
+		HANDLE mapping;
+		BY_HANDLE_FILE_INFORMATION info; // Identity and timestamp of the mapped file
+		bool memory;
+		void (*release)(void*);
+		void* release_data;
+		long refs;
+	};
+}
+
+using namespace SharpProj;
+
+const char SharpProj::shared_memory_prefix[] = "sharpproj-memory:";
+
+namespace {
+	SRWLOCK s_lock = SRWLOCK_INIT;
+	std::map<std::string, shared_file*>* s_files;
+	long long s_mappings; // Guarded by s_lock
+
+	bool utf8_to_wide(const char* utf8, std::wstring& wide)
+	{
+		int n = MultiByteToWideChar(CP_UTF8, 0, utf8, -1, nullptr, 0);
+		if (n <= 0)
+			return false;
+
+		wide.assign(n, L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, utf8, -1, &wide[0], n);
+		wide.resize(n - 1);
+		return true;
+	}
+
+	// Full path, case folded, as the key
+	bool shared_file_key(const char* utf8_path, std::wstring& path, std::string& key)
+	{
+		std::wstring wpath;
+		if (!utf8_to_wide(utf8_path, wpath))
+			return false;
+
+		DWORD len = GetFullPathNameW(wpath.c_str(), 0, nullptr, nullptr);
+		if (!len)
+			return false;
+
+		path.assign(len, L'\0');
+		len = GetFullPathNameW(wpath.c_str(), len, &path[0], nullptr);
+		path.resize(len);
+
+		std::wstring folded(path);
+		CharLowerBuffW(&folded[0], (DWORD)folded.size());
+
+		int n = WideCharToMultiByte(CP_UTF8, 0, folded.c_str(), (int)folded.size(), nullptr, 0, nullptr, nullptr);
+		if (n <= 0)
+			return false;
+
+		key.assign(n, '\0');
+		WideCharToMultiByte(CP_UTF8, 0, folded.c_str(), (int)folded.size(), &key[0], n, nullptr, nullptr);
+		return true;
+	}
+
+	// Whether info still describes the file at path, and not a file that replaced it
+	bool shared_file_current(const std::wstring& path, const BY_HANDLE_FILE_INFORMATION& info)
+	{
+		HANDLE h = CreateFileW(path.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (h == INVALID_HANDLE_VALUE)
+			return false;
+
+		BY_HANDLE_FILE_INFORMATION now;
+		bool ok = GetFileInformationByHandle(h, &now)
+			&& now.dwVolumeSerialNumber == info.dwVolumeSerialNumber
+			&& now.nFileIndexHigh == info.nFileIndexHigh && now.nFileIndexLow == info.nFileIndexLow
+			&& now.nFileSizeHigh == info.nFileSizeHigh && now.nFileSizeLow == info.nFileSizeLow
+			&& !CompareFileTime(&now.ftLastWriteTime, &info.ftLastWriteTime);
+
+		CloseHandle(h);
+		return ok;
+	}
+
+	bool is_memory_name(const char* name)
+	{
+		return !strncmp(name, shared_memory_prefix, sizeof(shared_memory_prefix) - 1);
+	}
+
+	void shared_file_close(shared_file* f)
+	{
+		if (f->memory && f->release)
+			f->release(f->release_data);
+		else if (f->memory)
+			VirtualFree((void*)f->data, 0, MEM_RELEASE);
+		else if (f->data)
+			UnmapViewOfFile(f->data);
+		if (f->mapping)
+			CloseHandle(f->mapping);
+		if (f->file && f->file != INVALID_HANDLE_VALUE)
+			CloseHandle(f->file);
+		delete f;
+	}
+}
+
+shared_file* SharpProj::shared_file_open(const char* utf8_path)
+{
+	std::wstring path;
+	std::string key;
+
+	if (!utf8_path || !*utf8_path)
+		return nullptr;
+
+	bool memory = is_memory_name(utf8_path);
+
+	if (memory)
+		key = utf8_path;
+	else if (!shared_file_key(utf8_path, path, key))
+		return nullptr;
+
+	AcquireSRWLockExclusive(&s_lock);
+
+	if (!s_files)
+		s_files = new std::map<std::string, shared_file*>();
+
+	// A file that was replaced (or modified) since it was mapped gets a new mapping. Users of the old one keep their data
+	auto it = s_files->find(key);
+	if (it != s_files->end() && (memory || shared_file_current(path, it->second->info)))
+	{
+		it->second->refs++;
+		ReleaseSRWLockExclusive(&s_lock);
+		return it->second;
+	}
+	else if (memory)
+	{
+		ReleaseSRWLockExclusive(&s_lock);
+		return nullptr;
+	}
+
+	shared_file* f = new shared_file();
+	f->key = key;
+	f->refs = 1;
+
+	// Allow replacing the file (e.g. a newer proj.db). Contexts that already use the old version keep it, later opens map the new file
+	f->file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	LARGE_INTEGER size;
+	if (f->file != INVALID_HANDLE_VALUE && GetFileInformationByHandle(f->file, &f->info) && GetFileSizeEx(f->file, &size) && size.QuadPart > 0
+		&& (unsigned long long)size.QuadPart <= (SIZE_MAX >> 1))
+	{
+		f->size = (unsigned long long)size.QuadPart;
+		f->mapping = CreateFileMappingW(f->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (f->mapping)
+			f->data = (const unsigned char*)MapViewOfFile(f->mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+
+	if (!f->data)
+	{
+		shared_file_close(f);
+		ReleaseSRWLockExclusive(&s_lock);
+		return nullptr;
+	}
+
+	(*s_files)[key] = f;
+	s_mappings++;
+	ReleaseSRWLockExclusive(&s_lock);
+	return f;
+}
+
+long long SharpProj::shared_file_mappings()
+{
+	AcquireSRWLockShared(&s_lock);
+	long long n = s_mappings;
+	ReleaseSRWLockShared(&s_lock);
+	return n;
+}
+
+namespace {
+	bool shared_file_publish(shared_file* f)
+	{
+		AcquireSRWLockExclusive(&s_lock);
+
+		if (!s_files)
+			s_files = new std::map<std::string, shared_file*>();
+
+		bool added = s_files->emplace(f->key, f).second;
+
+		ReleaseSRWLockExclusive(&s_lock);
+		return added;
+	}
+}
+
+shared_file* SharpProj::shared_file_create(const char* name, unsigned long long size, unsigned char** data)
+{
+	*data = nullptr;
+
+	if (!name || !is_memory_name(name) || !size || size > (SIZE_MAX >> 1))
+		return nullptr;
+
+	unsigned char* p = (unsigned char*)VirtualAlloc(nullptr, (SIZE_T)size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+
+	if (!p)
+		return nullptr;
+
+	shared_file* f = new shared_file();
+	f->key = name;
+	f->data = p;
+	f->size = size;
+	f->memory = true;
+	f->refs = 1;
+
+	if (!shared_file_publish(f))
+	{
+		shared_file_close(f);
+		return nullptr;
+	}
+
+	*data = p;
+	return f;
+}
+
+shared_file* SharpProj::shared_file_register(const char* name, const unsigned char* data, unsigned long long size, void (*release)(void*), void* release_data)
+{
+	if (!name || !is_memory_name(name) || !data || !size)
+		return nullptr;
+
+	shared_file* f = new shared_file();
+	f->key = name;
+	f->data = data;
+	f->size = size;
+	f->memory = true;
+	f->release = release;
+	f->release_data = release_data;
+	f->refs = 1;
+
+	if (!shared_file_publish(f))
+	{
+		delete f; // Without calling release
+		return nullptr;
+	}
+
+	return f;
+}
+
+bool SharpProj::shared_file_unregister(const char* name)
+{
+	shared_file* f = nullptr;
+
+	AcquireSRWLockExclusive(&s_lock);
+
+	if (s_files)
+	{
+		auto it = s_files->find(name);
+
+		if (it != s_files->end())
+		{
+			f = it->second;
+			s_files->erase(it);
+		}
+	}
+
+	bool found = (f != nullptr);
+	bool last = found && (--f->refs == 0);
+
+	ReleaseSRWLockExclusive(&s_lock);
+
+	if (last)
+		shared_file_close(f);
+	return found;
+}
+
+void SharpProj::shared_file_addref(shared_file* file)
+{
+	AcquireSRWLockExclusive(&s_lock);
+	file->refs++;
+	ReleaseSRWLockExclusive(&s_lock);
+}
+
+void SharpProj::shared_file_release(shared_file* file)
+{
+	if (!file)
+		return;
+
+	AcquireSRWLockExclusive(&s_lock);
+	bool last = (--file->refs == 0);
+
+	if (last)
+	{
+		auto it = s_files->find(file->key);
+		if (it != s_files->end() && it->second == file)
+			s_files->erase(it);
+	}
+	ReleaseSRWLockExclusive(&s_lock);
+
+	if (last)
+		shared_file_close(file);
+}
+
+const unsigned char* SharpProj::shared_file_data(const shared_file* file)
+{
+	return file->data;
+}
+
+unsigned long long SharpProj::shared_file_size(const shared_file* file)
+{
+	return file->size;
+}
+
+// The PROJ file API
+void* const SharpProj::shared_file_api_map_files = (void*)&s_lock;
+
+namespace {
+	volatile LONG64 s_api_reads;
+	volatile LONG64 s_api_bytes;
+	volatile LONG64 s_api_counts; // QueryPerformanceCounter units
+
+	struct shared_file_handle
+	{
+		shared_file* file; // Either a shared mapping
+		FILE* fp; // Or a plain file
+		unsigned long long pos;
+	};
+
+	PROJ_FILE_HANDLE* file_api_open(PJ_CONTEXT*, const char* filename, PROJ_OPEN_ACCESS access, void* user_data)
+	{
+		shared_file_handle* h;
+
+		if (access == PROJ_OPEN_ACCESS_READ_ONLY && (user_data == shared_file_api_map_files || is_memory_name(filename)))
+		{
+			shared_file* f = shared_file_open(filename);
+
+			if (f)
+			{
+				h = new shared_file_handle();
+				h->file = f;
+				return (PROJ_FILE_HANDLE*)h;
+			}
+		}
+
+		std::wstring wname;
+		if (is_memory_name(filename) || !utf8_to_wide(filename, wname))
+			return nullptr;
+
+		const wchar_t* mode = (access == PROJ_OPEN_ACCESS_READ_ONLY) ? L"rb" : (access == PROJ_OPEN_ACCESS_READ_UPDATE) ? L"r+b" : L"w+b";
+		FILE* fp = _wfsopen(wname.c_str(), mode, _SH_DENYNO);
+
+		if (!fp)
+			return nullptr;
+
+		h = new shared_file_handle();
+		h->fp = fp;
+		return (PROJ_FILE_HANDLE*)h;
+	}
+
+	size_t file_api_read_handle(shared_file_handle* h, void* buffer, size_t size)
+	{
+		if (h->fp)
+			return fread(buffer, 1, size, h->fp);
+
+		unsigned long long fsize = shared_file_size(h->file);
+
+		if (h->pos >= fsize)
+			return 0;
+		else if (size > fsize - h->pos)
+			size = (size_t)(fsize - h->pos);
+
+		memcpy(buffer, shared_file_data(h->file) + h->pos, size);
+		h->pos += size;
+		return size;
+	}
+
+	size_t file_api_read(PJ_CONTEXT*, PROJ_FILE_HANDLE* handle, void* buffer, size_t size, void*)
+	{
+		LARGE_INTEGER start, end;
+
+		QueryPerformanceCounter(&start);
+		size_t r = file_api_read_handle((shared_file_handle*)handle, buffer, size);
+		QueryPerformanceCounter(&end);
+
+		InterlockedIncrement64(&s_api_reads);
+		InterlockedAdd64(&s_api_bytes, (LONG64)r);
+		InterlockedAdd64(&s_api_counts, end.QuadPart - start.QuadPart);
+		return r;
+	}
+
+	size_t file_api_write(PJ_CONTEXT*, PROJ_FILE_HANDLE* handle, const void* buffer, size_t size, void*)
+	{
+		shared_file_handle* h = (shared_file_handle*)handle;
+
+		return h->fp ? fwrite(buffer, 1, size, h->fp) : 0;
+	}
+
+	int file_api_seek(PJ_CONTEXT*, PROJ_FILE_HANDLE* handle, long long offset, int whence, void*)
+	{
+		shared_file_handle* h = (shared_file_handle*)handle;
+
+		if (h->fp)
+			return _fseeki64(h->fp, offset, whence) == 0;
+
+		long long base = (whence == SEEK_SET) ? 0 : (whence == SEEK_CUR) ? (long long)h->pos : (long long)shared_file_size(h->file);
+
+		if (base + offset < 0)
+			return false;
+
+		h->pos = (unsigned long long)(base + offset);
+		return true;
+	}
+
+	unsigned long long file_api_tell(PJ_CONTEXT*, PROJ_FILE_HANDLE* handle, void*)
+	{
+		shared_file_handle* h = (shared_file_handle*)handle;
+
+		return h->fp ? (unsigned long long)_ftelli64(h->fp) : h->pos;
+	}
+
+	void file_api_close(PJ_CONTEXT*, PROJ_FILE_HANDLE* handle, void*)
+	{
+		shared_file_handle* h = (shared_file_handle*)handle;
+
+		if (h->fp)
+			fclose(h->fp);
+		else
+			shared_file_release(h->file);
+
+		delete h;
+	}
+
+	int file_api_exists(PJ_CONTEXT*, const char* filename, void*)
+	{
+		if (is_memory_name(filename))
+		{
+			shared_file* f = shared_file_open(filename);
+			shared_file_release(f);
+			return f != nullptr;
+		}
+
+		std::wstring wname;
+		return utf8_to_wide(filename, wname) && GetFileAttributesW(wname.c_str()) != INVALID_FILE_ATTRIBUTES;
+	}
+
+	int file_api_mkdir(PJ_CONTEXT*, const char* filename, void*)
+	{
+		std::wstring wname;
+		return utf8_to_wide(filename, wname) && CreateDirectoryW(wname.c_str(), nullptr);
+	}
+
+	int file_api_unlink(PJ_CONTEXT*, const char* filename, void*)
+	{
+		std::wstring wname;
+		return utf8_to_wide(filename, wname) && DeleteFileW(wname.c_str());
+	}
+
+	int file_api_rename(PJ_CONTEXT*, const char* oldPath, const char* newPath, void*)
+	{
+		std::wstring wold, wnew;
+		return utf8_to_wide(oldPath, wold) && utf8_to_wide(newPath, wnew)
+			&& MoveFileExW(wold.c_str(), wnew.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_COPY_ALLOWED);
+	}
+
+	const PROJ_FILE_API s_file_api =
+	{
+		1,
+		file_api_open,
+		file_api_read,
+		file_api_write,
+		file_api_seek,
+		file_api_tell,
+		file_api_close,
+		file_api_exists,
+		file_api_mkdir,
+		file_api_unlink,
+		file_api_rename
+	};
+}
+
+void SharpProj::shared_file_api_statistics(long long* reads, long long* bytes, long long* ticks)
+{
+	LARGE_INTEGER freq;
+
+	QueryPerformanceFrequency(&freq);
+
+	*reads = InterlockedCompareExchange64(&s_api_reads, 0, 0);
+	*bytes = InterlockedCompareExchange64(&s_api_bytes, 0, 0);
+	*ticks = (long long)(InterlockedCompareExchange64(&s_api_counts, 0, 0) * (10000000.0 / freq.QuadPart));
+}
+
+const PROJ_FILE_API* SharpProj::shared_proj_file_api()
+{
+	return &s_file_api;
+}
+
+// The SQLite VFS. Read-only main database opens are served from the shared mapping, everything else
+// (journals, temp files, writable databases) goes to the default VFS.
+namespace {
+	struct shared_db_file
+	{
+		sqlite3_file base;
+		shared_file* file;
+	};
+
+	sqlite3_vfs s_vfs;
+	sqlite3_vfs* s_default_vfs;
+	volatile LONG64 s_db_fetches;
+
+	// SQLite only uses xFetch() when memory mapped I/O is configured, which is only possible before it is initialized. This runs
+	// when the module is loaded, before any context can open a database
+	struct sqlite_mmap_config
+	{
+		sqlite_mmap_config()
+		{
+			sqlite3_config(SQLITE_CONFIG_MMAP_SIZE, (sqlite3_int64)256 * 1024 * 1024, (sqlite3_int64)0x7FFF0000);
+		}
+	} s_sqlite_mmap_config;
+
+	int shared_db_close(sqlite3_file* pFile)
+	{
+		shared_db_file* p = (shared_db_file*)pFile;
+		shared_file_release(p->file);
+		p->file = nullptr;
+		return SQLITE_OK;
+	}
+
+	int shared_db_read(sqlite3_file* pFile, void* buf, int amt, sqlite3_int64 offset)
+	{
+		shared_db_file* p = (shared_db_file*)pFile;
+		unsigned long long size = shared_file_size(p->file);
+		unsigned long long off = (unsigned long long)offset;
+		unsigned long long avail = (off < size) ? size - off : 0;
+
+		if (avail >= (unsigned long long)amt)
+		{
+			memcpy(buf, shared_file_data(p->file) + off, amt);
+			return SQLITE_OK;
+		}
+
+		if (avail)
+			memcpy(buf, shared_file_data(p->file) + off, (size_t)avail);
+		memset((char*)buf + avail, 0, (size_t)(amt - avail));
+		return SQLITE_IOERR_SHORT_READ;
+	}
+
+	int shared_db_write(sqlite3_file*, const void*, int, sqlite3_int64)
+	{
+		return SQLITE_READONLY;
+	}
+
+	int shared_db_truncate(sqlite3_file*, sqlite3_int64)
+	{
+		return SQLITE_READONLY;
+	}
+
+	int shared_db_sync(sqlite3_file*, int)
+	{
+		return SQLITE_OK;
+	}
+
+	int shared_db_file_size(sqlite3_file* pFile, sqlite3_int64* pSize)
+	{
+		*pSize = (sqlite3_int64)shared_file_size(((shared_db_file*)pFile)->file);
+		return SQLITE_OK;
+	}
+
+	// The file is immutable, so no locking is necessary
+	int shared_db_lock(sqlite3_file*, int)
+	{
+		return SQLITE_OK;
+	}
+
+	int shared_db_check_reserved_lock(sqlite3_file*, int* pResOut)
+	{
+		*pResOut = 0;
+		return SQLITE_OK;
+	}
+
+	int shared_db_file_control(sqlite3_file*, int, void*)
+	{
+		return SQLITE_NOTFOUND;
+	}
+
+	int shared_db_sector_size(sqlite3_file*)
+	{
+		return 4096;
+	}
+
+	int shared_db_device_characteristics(sqlite3_file*)
+	{
+		return SQLITE_IOCAP_IMMUTABLE;
+	}
+
+	// Hands out pages directly from the mapping, so connections don't need their own copy in the page cache
+	int shared_db_fetch(sqlite3_file* pFile, sqlite3_int64 offset, int amt, void** pp)
+	{
+		shared_db_file* p = (shared_db_file*)pFile;
+		unsigned long long off = (unsigned long long)offset;
+
+		if (off + amt <= shared_file_size(p->file))
+		{
+			*pp = (void*)(shared_file_data(p->file) + off);
+			InterlockedIncrement64(&s_db_fetches);
+		}
+		else
+			*pp = nullptr;
+
+		return SQLITE_OK;
+	}
+
+	int shared_db_unfetch(sqlite3_file*, sqlite3_int64, void*)
+	{
+		return SQLITE_OK;
+	}
+
+	const sqlite3_io_methods s_io_methods =
+	{
+		3,
+		shared_db_close,
+		shared_db_read,
+		shared_db_write,
+		shared_db_truncate,
+		shared_db_sync,
+		shared_db_file_size,
+		shared_db_lock,
+		shared_db_lock, // xUnlock
+		shared_db_check_reserved_lock,
+		shared_db_file_control,
+		shared_db_sector_size,
+		shared_db_device_characteristics,
+		nullptr, // xShmMap
+		nullptr, // xShmLock
+		nullptr, // xShmBarrier
+		nullptr, // xShmUnmap
+		shared_db_fetch,
+		shared_db_unfetch
+	};
+
+	int shared_vfs_open(sqlite3_vfs* pVfs, const char* zName, sqlite3_file* pFile, int flags, int* pOutFlags)
+	{
+		if (zName && (flags & SQLITE_OPEN_MAIN_DB) && (flags & SQLITE_OPEN_READONLY) && !(flags & SQLITE_OPEN_CREATE))
+		{
+			shared_file* f = shared_file_open(zName);
+
+			if (f)
+			{
+				shared_db_file* p = (shared_db_file*)pFile;
+				p->base.pMethods = &s_io_methods;
+				p->file = f;
+
+				if (pOutFlags)
+					*pOutFlags = flags;
+				return SQLITE_OK;
+			}
+		}
+
+		if (zName && is_memory_name(zName))
+			return SQLITE_CANTOPEN;
+
+		// szOsFile is at least the size the default VFS needs, so it can use our file structure directly
+		return s_default_vfs->xOpen(s_default_vfs, zName, pFile, flags, pOutFlags);
+	}
+
+	int shared_vfs_delete(sqlite3_vfs*, const char* zName, int syncDir)
+	{
+		return s_default_vfs->xDelete(s_default_vfs, zName, syncDir);
+	}
+
+	int shared_vfs_access(sqlite3_vfs*, const char* zName, int flags, int* pResOut)
+	{
+		if (zName && is_memory_name(zName))
+		{
+			shared_file* f = (flags == SQLITE_ACCESS_READWRITE) ? nullptr : shared_file_open(zName);
+
+			*pResOut = (f != nullptr);
+			shared_file_release(f);
+			return SQLITE_OK;
+		}
+
+		return s_default_vfs->xAccess(s_default_vfs, zName, flags, pResOut);
+	}
+
+	int shared_vfs_full_pathname(sqlite3_vfs*, const char* zName, int nOut, char* zOut)
+	{
+		if (is_memory_name(zName))
+		{
+			size_t len = strlen(zName);
+
+			if (len >= (size_t)nOut)
+				return SQLITE_CANTOPEN;
+
+			memcpy(zOut, zName, len + 1);
+			return SQLITE_OK;
+		}
+
+		return s_default_vfs->xFullPathname(s_default_vfs, zName, nOut, zOut);
+	}
+}
+
+const char* SharpProj::shared_sqlite_vfs_name()
+{
+	static const char name[] = "sharpproj_shared";
+
+	AcquireSRWLockExclusive(&s_lock);
+
+	if (!s_default_vfs)
+	{
+		sqlite3_vfs* def = sqlite3_vfs_find(nullptr);
+
+		if (def)
+		{
+			s_vfs = *def; // Inherit randomness, sleep, time, dlopen and syscall handling
+			s_vfs.szOsFile = (def->szOsFile > (int)sizeof(shared_db_file)) ? def->szOsFile : (int)sizeof(shared_db_file);
+			s_vfs.pNext = nullptr;
+			s_vfs.zName = name;
+			s_vfs.pAppData = nullptr;
+			s_vfs.xOpen = shared_vfs_open;
+			s_vfs.xDelete = shared_vfs_delete;
+			s_vfs.xAccess = shared_vfs_access;
+			s_vfs.xFullPathname = shared_vfs_full_pathname;
+
+			if (sqlite3_vfs_register(&s_vfs, 0) == SQLITE_OK)
+				s_default_vfs = def;
+		}
+	}
+
+	ReleaseSRWLockExclusive(&s_lock);
+
+	return s_default_vfs ? name : nullptr;
+}
+
+long long SharpProj::shared_sqlite_fetches()
+{
+	return InterlockedCompareExchange64(&s_db_fetches, 0, 0);
+}
+
+#pragma managed(pop)
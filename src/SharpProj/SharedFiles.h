@@ -0,0 +1,43 @@
+#pragma once
+
+// Process wide registry of read-only files, memory mapped once and shared by all contexts.
+// All functions are thread safe.
+
+namespace SharpProj {
+	struct shared_file;
+
+	// Maps the file at utf8_path, or adds a reference to the existing mapping of that file. Returns nullptr on failure
+	shared_file* shared_file_open(const char* utf8_path);
+	void shared_file_addref(shared_file* file);
+
+	// Names starting with this prefix refer to in-memory files. They never touch the file system
+	extern const char shared_memory_prefix[];
+
+	// Creates an in-memory file of size bytes under name (which must start with shared_memory_prefix), returning its
+	// (writable) buffer via data. The caller fills the buffer before handing out the name. Returns nullptr on failure
+	shared_file* shared_file_create(const char* name, unsigned long long size, unsigned char** data);
+	// Registers existing memory as in-memory file under name. release(release_data) is called when the last reference is
+	// released. Returns nullptr on failure, in which case release is not called
+	shared_file* shared_file_register(const char* name, const unsigned char* data, unsigned long long size, void (*release)(void*), void* release_data);
+	// Removes name from the registry and releases the reference returned when it was created or registered. Files that are
+	// still open keep their data
+	bool shared_file_unregister(const char* name);
+	void shared_file_release(shared_file* file);
+
+	const unsigned char* shared_file_data(const shared_file* file);
+	unsigned long long shared_file_size(const shared_file* file);
+
+	// PROJ file API that serves read-only opens from the shared mappings (and in-memory files), falling back to stdio.
+	// Pass shared_file_api_map_files as user data to map files from disk; in-memory files are always served
+	const PROJ_FILE_API* shared_proj_file_api();
+	extern void* const shared_file_api_map_files;
+	// Process wide totals of the reads through the file API. ticks are in 100ns units
+	void shared_file_api_statistics(long long* reads, long long* bytes, long long* ticks);
+	// The number of files mapped from disk by the registry so far. Opening an already mapped file doesn't add a mapping
+	long long shared_file_mappings();
+
+	// Registers (once) the SQLite VFS that serves read-only database opens from the shared mappings. Returns its name
+	const char* shared_sqlite_vfs_name();
+	// The number of database pages SQLite used directly from the shared mappings (via xFetch), instead of copying them
+	long long shared_sqlite_fetches();
+}
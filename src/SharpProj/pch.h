@@ -45,7 +45,34 @@ using namespace SharpProj;
 using namespace SharpProj::Proj;
 
 #include <string>
-std::string utf8_string(String^ v);
+
+// Encodes a String as null terminated UTF-8, directly from the managed characters. Strings that fit use the
+// buffer inside the instance (typically on the stack), so no heap allocations are needed
+class utf8_str
+{
+public:
+	explicit utf8_str(String^ value);
+	~utf8_str()
+	{
+		if (m_p != m_buf)
+			delete[] m_p;
+	}
+
+	const char* c_str() const { return m_p; }
+	size_t size() const { return m_len; }
+
+private:
+	utf8_str(const utf8_str&) = delete;
+	utf8_str& operator=(const utf8_str&) = delete;
+
+	char* m_p;
+	size_t m_len;
+	char m_buf[256];
+};
+
+// Like Utf8_PtrToString, but returns a shared instance for recently seen short strings. For metadata (names, units, ...)
+// that is read over and over again
+String^ Utf8_PtrToInternedString(const char* pTxt);
 
 using Out = System::Runtime::InteropServices::OutAttribute;
 using Optional = System::Runtime::InteropServices::OptionalAttribute;